@@ -0,0 +1,118 @@
+#include "alloctrack.h"
+
+#ifdef HAVE_ALLOC_TRACK
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* pointer, size_t size);
+void __real_free(void* pointer);
+
+static __thread uint64_t allocations;
+static __thread uint64_t bytes;
+static __thread uint64_t frees;
+
+static struct {
+    const char* name;
+    uint64_t allocations;
+    uint64_t bytes;
+    uint64_t frees;
+} stages[ALLOC_TRACK_MAX_STAGES];
+
+static unsigned stageCount;
+static unsigned reportFrames;
+static uint64_t last[3];
+static char armed;
+static unsigned violations;
+
+// The wrappers only count; anything that might allocate itself, like
+// printing, waits for the next stage boundary.
+
+void* __wrap_malloc(size_t size) {
+    allocations++;
+    bytes += size;
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    allocations++;
+    bytes += count * size;
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* pointer, size_t size) {
+    allocations++;
+    bytes += size;
+    return __real_realloc(pointer, size);
+}
+
+void __wrap_free(void* pointer) {
+    if (pointer) {
+        frees++;
+    }
+    __real_free(pointer);
+}
+
+void alloc_track_begin() {
+    last[0] = allocations;
+    last[1] = bytes;
+    last[2] = frees;
+}
+
+void alloc_track_stage(const char* stage) {
+    uint64_t now[] = { allocations, bytes, frees };
+    uint64_t count = now[0] - last[0];
+
+    unsigned s = 0;
+    while (s < stageCount && stages[s].name != stage) {
+        s++;
+    }
+    if (s == stageCount && s < ALLOC_TRACK_MAX_STAGES) {
+        stages[stageCount++].name = stage;
+    }
+    if (s < stageCount) {
+        stages[s].allocations += count;
+        stages[s].bytes += now[1] - last[1];
+        stages[s].frees += now[2] - last[2];
+    }
+
+    if (armed && count) {
+        fprintf(stderr, "AllocTrack: %llu allocations (%llu bytes) in %s after warmup\n",
+            (unsigned long long)count, (unsigned long long)(now[1] - last[1]), stage);
+        violations += count;
+    }
+
+    // Printing may have allocated; don't charge that to the next stage.
+    alloc_track_begin();
+}
+
+void alloc_track_frame() {
+    if (++reportFrames < ALLOC_TRACK_REPORT_FRAMES) {
+        return;
+    }
+
+    printf("AllocTrack: per frame over %u frames:", reportFrames);
+    for (unsigned s = 0; s < stageCount; s++) {
+        printf(" %s %.1f (%.0f B, %.1f frees)", stages[s].name,
+            (double)stages[s].allocations / reportFrames,
+            (double)stages[s].bytes / reportFrames,
+            (double)stages[s].frees / reportFrames);
+
+        stages[s].allocations = stages[s].bytes = stages[s].frees = 0;
+    }
+    printf("\n");
+
+    reportFrames = 0;
+    alloc_track_begin();
+}
+
+void alloc_track_arm() {
+    printf("AllocTrack: warmed up, asserting no further allocations\n");
+    armed = 1;
+    alloc_track_begin();
+}
+
+unsigned alloc_track_violations() {
+    return violations;
+}
+
+#endif // HAVE_ALLOC_TRACK
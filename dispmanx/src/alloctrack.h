@@ -0,0 +1,43 @@
+#ifndef ALLOCTRACK_H
+#define ALLOCTRACK_H
+
+// Counts the heap allocations this program's own code makes, per stage of
+// the frame loop. Built with `make ALLOC_TRACK=1`, which links malloc,
+// calloc, realloc and free through wrappers (-Wl,--wrap); allocations inside
+// shared libraries such as Cairo or the GL driver aren't seen. Otherwise
+// every call below expands to nothing.
+
+// Frames the loop runs before --assert-no-alloc starts failing allocations;
+// the first frames may still create targets and grow buffers.
+#define ALLOC_TRACK_WARMUP_FRAMES                                     10
+
+#ifdef HAVE_ALLOC_TRACK
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define ALLOC_TRACK_MAX_STAGES                                         8
+#define ALLOC_TRACK_REPORT_FRAMES                                    120
+
+// Counting is per thread; the stages are the calling thread's.
+void alloc_track_begin();
+void alloc_track_stage(const char* stage);
+void alloc_track_frame();
+
+// From here on, any allocation on the calling thread is a violation, logged
+// at the stage boundary that sees it.
+void alloc_track_arm();
+unsigned alloc_track_violations();
+
+#else
+
+#define alloc_track_begin()
+#define alloc_track_stage(stage)
+#define alloc_track_frame()
+#define alloc_track_arm()
+#define alloc_track_violations()                                       0
+
+#endif // HAVE_ALLOC_TRACK
+
+#endif // ALLOCTRACK_H
@@ -0,0 +1,208 @@
+#include "antialias.h"
+
+static const char* names[] = { "off", "msaa2", "msaa4", "fxaa" };
+
+static const GLchar* fxaa_vshader_source =
+    "attribute vec2 position;"
+
+    "varying vec2 Texcoord;"
+
+    "void main() {"
+    " Texcoord = position * 0.5 + 0.5;"
+    " gl_Position = vec4(position, 0.0, 1.0);"
+    "}";
+
+// FXAA in its cheapest form: estimate the local edge direction from the luma
+// of the four diagonal neighbours, blend along it, and keep the narrower
+// blend if the wider one overshoots the neighbourhood's luma range.
+static const GLchar* fxaa_fshader_source =
+    "precision mediump float;"
+
+    "varying vec2 Texcoord;"
+
+    "uniform sampler2D tex;"
+    "uniform vec2 texelSize;"
+
+    "void main() {"
+    " vec3 luma = vec3(0.299, 0.587, 0.114);"
+    " vec3 rgbM = texture2D(tex, Texcoord).rgb;"
+    " float lumaNW = dot(texture2D(tex, Texcoord + vec2(-1.0, -1.0) * texelSize).rgb, luma);"
+    " float lumaNE = dot(texture2D(tex, Texcoord + vec2( 1.0, -1.0) * texelSize).rgb, luma);"
+    " float lumaSW = dot(texture2D(tex, Texcoord + vec2(-1.0,  1.0) * texelSize).rgb, luma);"
+    " float lumaSE = dot(texture2D(tex, Texcoord + vec2( 1.0,  1.0) * texelSize).rgb, luma);"
+    " float lumaM = dot(rgbM, luma);"
+    " float lumaMin = min(lumaM, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));"
+    " float lumaMax = max(lumaM, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));"
+
+    " vec2 dir = vec2(-((lumaNW + lumaNE) - (lumaSW + lumaSE)), (lumaNW + lumaSW) - (lumaNE + lumaSE));"
+    " float dirReduce = max((lumaNW + lumaNE + lumaSW + lumaSE) * (0.25 / 8.0), 1.0 / 128.0);"
+    " float rcpDirMin = 1.0 / (min(abs(dir.x), abs(dir.y)) + dirReduce);"
+    " dir = clamp(dir * rcpDirMin, vec2(-8.0), vec2(8.0)) * texelSize;"
+
+    " vec3 rgbA = 0.5 * (texture2D(tex, Texcoord + dir * (1.0 / 3.0 - 0.5)).rgb +"
+    "                    texture2D(tex, Texcoord + dir * (2.0 / 3.0 - 0.5)).rgb);"
+    " vec3 rgbB = rgbA * 0.5 + 0.25 * (texture2D(tex, Texcoord - dir * 0.5).rgb +"
+    "                                  texture2D(tex, Texcoord + dir * 0.5).rgb);"
+    " float lumaB = dot(rgbB, luma);"
+
+    " gl_FragColor = vec4((lumaB < lumaMin || lumaB > lumaMax) ? rgbA : rgbB, 1.0);"
+    "}";
+
+char antialias_parse(const char* name, AntiAliasMode* mode) {
+    for (unsigned i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (!strcmp(names[i], name)) {
+            *mode = i;
+            return 1;
+        }
+    }
+
+    fprintf(stderr, "AA: unknown mode %s; use off, msaa2, msaa4 or fxaa.\n", name);
+
+    return 0;
+}
+
+const char* antialias_name(AntiAliasMode mode) {
+    return names[mode];
+}
+
+EGLint antialias_samples(AntiAliasMode mode) {
+    switch (mode) {
+        case ANTIALIAS_MSAA2: return 2;
+        case ANTIALIAS_MSAA4: return 4;
+        default:              return 0;
+    }
+}
+
+AntiAlias* antialias_init(AntiAlias* a, Window* window, ProgramCache* cache, AntiAliasMode mode) {
+    AntiAlias* antialias = a ? a : NEW(AntiAlias, 1);
+
+    memset(antialias, 0, sizeof(AntiAlias));
+    antialias->window = window;
+    antialias->mode = mode;
+
+    // The window may not have had a config with the samples asked for.
+    if (antialias_samples(mode) && window->samples != antialias_samples(mode)) {
+        antialias->mode = window->samples >= 4 ? ANTIALIAS_MSAA4 : window->samples >= 2 ? ANTIALIAS_MSAA2 : ANTIALIAS_OFF;
+    }
+
+    printf("AA: %s\n", antialias_name(antialias->mode));
+
+    if (antialias->mode != ANTIALIAS_FXAA) {
+        return antialias;
+    }
+
+    // Target
+
+    gl_resources_gen(GL_RESOURCE_TEXTURE, &antialias->colorTexture, "fxaa color");
+    glBindTexture(GL_TEXTURE_2D, antialias->colorTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, window->width, window->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    gl_resources_storage(GL_RESOURCE_TEXTURE, antialias->colorTexture, window->width * window->height * 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    gl_resources_gen(GL_RESOURCE_RENDERBUFFER, &antialias->depthRenderbuffer, "fxaa depth");
+    glBindRenderbuffer(GL_RENDERBUFFER, antialias->depthRenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT16, window->width, window->height);
+    gl_resources_storage(GL_RESOURCE_RENDERBUFFER, antialias->depthRenderbuffer, window->width * window->height * 2);
+
+    gl_resources_gen(GL_RESOURCE_FRAMEBUFFER, &antialias->framebuffer, "fxaa");
+    glBindFramebuffer(GL_FRAMEBUFFER, antialias->framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, antialias->colorTexture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, antialias->depthRenderbuffer);
+    assert(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, window->framebuffer);
+
+    glCheck();
+
+    // Filter pass: one triangle covering the screen
+
+    antialias->program = gl_resources_track(GL_RESOURCE_PROGRAM, program_cache_build(cache, fxaa_vshader_source, fxaa_fshader_source, NULL), "fxaa");
+
+    glUseProgram(antialias->program);
+    glUniform1i(glGetUniformLocation(antialias->program, "tex"), 0);
+    glUniform2f(glGetUniformLocation(antialias->program, "texelSize"), 1.0f / window->width, 1.0f / window->height);
+    glUseProgram(0);
+
+    const GLfloat vertices[] = {
+        -1.0f, -1.0f,
+         3.0f, -1.0f,
+        -1.0f,  3.0f,
+    };
+
+    gl_resources_gen(GL_RESOURCE_BUFFER, &antialias->vbo, "fxaa");
+    glBindBuffer(GL_ARRAY_BUFFER, antialias->vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    gl_resources_storage(GL_RESOURCE_BUFFER, antialias->vbo, sizeof(vertices));
+
+    glCheck();
+
+    return antialias;
+}
+
+void antialias_destroy(AntiAlias* antialias) {
+    if (antialias->mode != ANTIALIAS_FXAA) {
+        return;
+    }
+
+    gl_resources_delete(GL_RESOURCE_BUFFER, &antialias->vbo);
+    gl_resources_delete(GL_RESOURCE_PROGRAM, &antialias->program);
+    gl_resources_delete(GL_RESOURCE_FRAMEBUFFER, &antialias->framebuffer);
+    gl_resources_delete(GL_RESOURCE_RENDERBUFFER, &antialias->depthRenderbuffer);
+    gl_resources_delete(GL_RESOURCE_TEXTURE, &antialias->colorTexture);
+}
+
+void antialias_begin(AntiAlias* antialias) {
+    if (antialias->mode == ANTIALIAS_FXAA) {
+        glBindFramebuffer(GL_FRAMEBUFFER, antialias->framebuffer);
+    }
+
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+void antialias_end(AntiAlias* antialias) {
+    if (antialias->mode != ANTIALIAS_FXAA) {
+        return;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, antialias->window->framebuffer);
+
+    // The filtered scene covers every pixel; only depth needs clearing for
+    // the HUD drawn after it.
+    glClear(GL_DEPTH_BUFFER_BIT);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+
+    glUseProgram(antialias->program);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, antialias->colorTexture);
+
+    GLint positionAttribute = glGetAttribLocation(antialias->program, "position");
+
+    glBindBuffer(GL_ARRAY_BUFFER, antialias->vbo);
+    glEnableVertexAttribArray(positionAttribute);
+    glVertexAttribPointer(positionAttribute, 2, GL_FLOAT, 0, 2*sizeof(GLfloat), (const GLvoid*)0);
+
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    glEnable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+
+    glCheck();
+}
+
+void antialias_record(AntiAlias* antialias, float frameMillis) {
+    antialias->reportFrames++;
+    antialias->reportMillis += frameMillis;
+
+    if (antialias->reportFrames == ANTIALIAS_REPORT_FRAMES) {
+        printf("AA: %s, mean render %.3f ms over %u frames\n",
+            antialias_name(antialias->mode), antialias->reportMillis / antialias->reportFrames, antialias->reportFrames);
+
+        antialias->reportFrames = 0;
+        antialias->reportMillis = 0;
+    }
+}
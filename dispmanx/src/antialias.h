@@ -0,0 +1,57 @@
+#ifndef ANTIALIAS_H
+#define ANTIALIAS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "GLES2/gl2.h"
+
+#include "global.h"
+#include "window.h"
+#include "programcache.h"
+#include "glresources.h"
+
+#define ANTIALIAS_REPORT_FRAMES                                      120
+
+typedef enum {
+    ANTIALIAS_OFF,
+    ANTIALIAS_MSAA2,
+    ANTIALIAS_MSAA4,
+    ANTIALIAS_FXAA
+} AntiAliasMode;
+
+// MSAA comes from the EGL config, so it only needs the sample count when the
+// window is created. FXAA renders the scene into an offscreen target and
+// filters it onto the window in one pass.
+typedef struct {
+    AntiAliasMode mode;
+    Window* window;
+
+    GLuint framebuffer;
+    GLuint colorTexture;
+    GLuint depthRenderbuffer;
+    GLuint program;
+    GLuint vbo;
+
+    unsigned reportFrames;
+    double reportMillis;
+} AntiAlias;
+
+char antialias_parse(const char* name, AntiAliasMode* mode);
+const char* antialias_name(AntiAliasMode mode);
+EGLint antialias_samples(AntiAliasMode mode);
+
+AntiAlias* antialias_init(AntiAlias* a, Window* window, ProgramCache* cache, AntiAliasMode mode);
+void antialias_destroy(AntiAlias* antialias);
+
+// Bracket the scene: begin binds and clears the target, end filters it onto
+// the window. Both only clear and do nothing else unless the mode is FXAA.
+void antialias_begin(AntiAlias* antialias);
+void antialias_end(AntiAlias* antialias);
+
+// Accumulates render times and prints the mode's mean cost periodically;
+// the frame loop only times rendering with --budget.
+void antialias_record(AntiAlias* antialias, float frameMillis);
+
+#endif // ANTIALIAS_H
@@ -0,0 +1,195 @@
+#include "gldebug.h"
+
+#ifndef GL_DEBUG_DEFAULT
+#define GL_DEBUG_DEFAULT                                  GL_DEBUG_ASYNC
+#endif
+
+static const char* names[] = { "off", "async", "strict" };
+
+static GlDebugMode mode = GL_DEBUG_DEFAULT;
+
+// The last glCheck() passed. Messages may arrive on a driver thread in the
+// async mode, so the site is read and written atomically, if not together.
+static const char* siteFile = "startup";
+static int siteLine;
+
+static unsigned messages;
+
+// Whether the KHR_debug callback is installed.
+static char supported;
+
+#ifdef GL_KHR_debug
+static PFNGLOBJECTLABELKHRPROC objectLabel;
+
+static const char* source_name(GLenum source) {
+    switch (source) {
+        case GL_DEBUG_SOURCE_API_KHR:             return "api";
+        case GL_DEBUG_SOURCE_WINDOW_SYSTEM_KHR:   return "window system";
+        case GL_DEBUG_SOURCE_SHADER_COMPILER_KHR: return "shader compiler";
+        case GL_DEBUG_SOURCE_THIRD_PARTY_KHR:     return "third party";
+        case GL_DEBUG_SOURCE_APPLICATION_KHR:     return "application";
+        default:                                  return "other";
+    }
+}
+
+static const char* type_name(GLenum type) {
+    switch (type) {
+        case GL_DEBUG_TYPE_ERROR_KHR:               return "error";
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR_KHR: return "deprecated";
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR_KHR:  return "undefined behavior";
+        case GL_DEBUG_TYPE_PORTABILITY_KHR:         return "portability";
+        case GL_DEBUG_TYPE_PERFORMANCE_KHR:         return "performance";
+        default:                                    return "other";
+    }
+}
+
+static const char* severity_name(GLenum severity) {
+    switch (severity) {
+        case GL_DEBUG_SEVERITY_HIGH_KHR:   return "high";
+        case GL_DEBUG_SEVERITY_MEDIUM_KHR: return "medium";
+        case GL_DEBUG_SEVERITY_LOW_KHR:    return "low";
+        default:                           return "notification";
+    }
+}
+
+static void GL_APIENTRY on_message(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* user) {
+    (void)length;
+    (void)user;
+
+    // A driver that repeats itself every frame would drown everything else.
+    unsigned count = __atomic_add_fetch(&messages, 1, __ATOMIC_RELAXED);
+    if (count > GL_DEBUG_MAX_MESSAGES) {
+        return;
+    }
+
+    const char* file = __atomic_load_n(&siteFile, __ATOMIC_RELAXED);
+    int line = __atomic_load_n(&siteLine, __ATOMIC_RELAXED);
+
+    fprintf(stderr, "GL: %s %s (%s, %s, id %u) %s %s:%d: %s\n",
+        severity_name(severity), type_name(type), source_name(source), names[mode], id,
+        mode == GL_DEBUG_STRICT ? "at" : "after", file, line, message);
+
+    if (count == GL_DEBUG_MAX_MESSAGES) {
+        fprintf(stderr, "GL: further messages are counted but not printed\n");
+    }
+}
+#endif
+
+char gl_debug_parse(const char* name, GlDebugMode* m) {
+    for (unsigned i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (!strcmp(names[i], name)) {
+            *m = i;
+            return 1;
+        }
+    }
+
+    fprintf(stderr, "GL: unknown debug mode %s; use off, async or strict.\n", name);
+
+    return 0;
+}
+
+const char* gl_debug_name(GlDebugMode m) {
+    return names[m];
+}
+
+void gl_debug_set_mode(GlDebugMode m) {
+    mode = m;
+}
+
+char gl_debug_wants_context() {
+    return mode != GL_DEBUG_OFF;
+}
+
+void gl_debug_init() {
+    if (mode == GL_DEBUG_OFF) {
+        printf("GL: debug %s\n", names[mode]);
+        return;
+    }
+
+#ifdef GL_KHR_debug
+    const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+    if (extensions && strstr(extensions, "GL_KHR_debug")) {
+        PFNGLDEBUGMESSAGECALLBACKKHRPROC debugMessageCallback = (PFNGLDEBUGMESSAGECALLBACKKHRPROC)eglGetProcAddress("glDebugMessageCallbackKHR");
+        PFNGLDEBUGMESSAGECONTROLKHRPROC debugMessageControl = (PFNGLDEBUGMESSAGECONTROLKHRPROC)eglGetProcAddress("glDebugMessageControlKHR");
+
+        if (debugMessageCallback && debugMessageControl) {
+            debugMessageCallback(on_message, NULL);
+
+            // Notifications are chatter, e.g. which memory a buffer went to.
+            debugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, NULL, GL_TRUE);
+            debugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION_KHR, 0, NULL, GL_FALSE);
+
+            glEnable(GL_DEBUG_OUTPUT_KHR);
+            if (mode == GL_DEBUG_STRICT) {
+                glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS_KHR);
+            } else {
+                glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS_KHR);
+            }
+
+            objectLabel = (PFNGLOBJECTLABELKHRPROC)eglGetProcAddress("glObjectLabelKHR");
+            supported = 1;
+        }
+    }
+#endif
+
+    printf("GL: debug %s, %s\n", names[mode], supported ? "KHR_debug messages" :
+        mode == GL_DEBUG_STRICT ? "glGetError only (no KHR_debug)" : "no KHR_debug, glGetError once a frame");
+}
+
+void gl_debug_frame() {
+    if (mode != GL_DEBUG_ASYNC || supported) {
+        return;
+    }
+
+    // Errors queue up until read; the check site narrows down where.
+    GLenum error;
+    while ((error = glGetError()) != GL_NO_ERROR) {
+        unsigned count = __atomic_add_fetch(&messages, 1, __ATOMIC_RELAXED);
+        if (count <= GL_DEBUG_MAX_MESSAGES) {
+            fprintf(stderr, "GL: error 0x%04x in the frame, after %s:%d\n", error, siteFile, siteLine);
+        }
+        if (count == GL_DEBUG_MAX_MESSAGES) {
+            fprintf(stderr, "GL: further messages are counted but not printed\n");
+        }
+    }
+}
+
+void gl_debug_destroy() {
+    unsigned count = __atomic_load_n(&messages, __ATOMIC_RELAXED);
+    if (count > GL_DEBUG_MAX_MESSAGES) {
+        fprintf(stderr, "GL: %u debug messages, %u not printed\n", count, count - GL_DEBUG_MAX_MESSAGES);
+    }
+}
+
+void gl_debug_label(GLenum identifier, GLuint name, const char* label) {
+#ifdef GL_KHR_debug
+    if (objectLabel && name) {
+        objectLabel(identifier, name, -1, label);
+    }
+#endif
+}
+
+void gl_debug_check(const char* file, int line) {
+    if (mode == GL_DEBUG_OFF) {
+        return;
+    }
+
+    __atomic_store_n(&siteFile, file, __ATOMIC_RELAXED);
+    __atomic_store_n(&siteLine, line, __ATOMIC_RELAXED);
+
+    if (mode != GL_DEBUG_STRICT) {
+        return;
+    }
+
+    GLenum error = glGetError();
+    if (error == GL_NO_ERROR) {
+        return;
+    }
+
+    // Errors queue up; report all of them before giving up.
+    do {
+        fprintf(stderr, "GL: error 0x%04x at %s:%d\n", error, file, line);
+    } while ((error = glGetError()) != GL_NO_ERROR);
+
+    abort();
+}
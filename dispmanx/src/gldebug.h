@@ -0,0 +1,58 @@
+#ifndef GLDEBUG_H
+#define GLDEBUG_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "GLES2/gl2.h"
+#include "GLES2/gl2ext.h"
+#include "EGL/egl.h"
+
+#include "global.h"
+
+#define GL_DEBUG_MAX_MESSAGES                                         64
+
+typedef enum {
+    // glCheck() does nothing.
+    GL_DEBUG_OFF,
+    // The driver reports errors and warnings through KHR_debug, whenever it
+    // gets to them; glCheck() only records where the program is, so that
+    // messages can name the last check passed before them. Nothing waits on
+    // the GPU. Without KHR_debug, gl_debug_frame() reports the frame's
+    // errors with one glGetError drain.
+    GL_DEBUG_ASYNC,
+    // glCheck() calls glGetError and aborts on an error, as the old
+    // assert did, and KHR_debug messages are delivered synchronously from
+    // the call that caused them. Every check stalls the pipeline.
+    GL_DEBUG_STRICT
+} GlDebugMode;
+
+// Parses off, async or strict; prints the choices and returns 0 otherwise.
+char gl_debug_parse(const char* name, GlDebugMode* mode);
+const char* gl_debug_name(GlDebugMode mode);
+
+// Sets what glCheck() does. Call before the context is created so that
+// window setup is checked too; GL_DEBUG_DEFAULT picks the default at build
+// time, otherwise it is async.
+void gl_debug_set_mode(GlDebugMode mode);
+
+// Whether to ask EGL for a debug context: in every mode but off.
+char gl_debug_wants_context();
+
+// With the context current: installs the KHR_debug callback in the async
+// and strict modes, if the driver has the extension.
+void gl_debug_init();
+
+// Call once a frame, after the frame's GL calls: in the async mode without
+// KHR_debug, reports the errors they raised.
+void gl_debug_frame();
+
+// Prints how many messages were received and suppressed.
+void gl_debug_destroy();
+
+// Gives the object a name that KHR_debug messages will use, e.g.
+// GL_BUFFER_KHR. Does nothing without the extension.
+void gl_debug_label(GLenum identifier, GLuint name, const char* label);
+
+#endif // GLDEBUG_H
@@ -3,6 +3,10 @@
 
 #define NEW(type, count)     (type*)malloc(count * sizeof(type));
 
-#define glCheck() assert(glGetError() == 0)
+// Checks for GL errors as the mode set in gldebug.h says: not at all,
+// through KHR_debug without waiting on the GPU, or with glGetError.
+#define glCheck() gl_debug_check(__FILE__, __LINE__)
+
+void gl_debug_check(const char* file, int line);
 
 #endif // GLOBAL_H
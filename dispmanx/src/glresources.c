@@ -0,0 +1,159 @@
+#include "glresources.h"
+
+static const char* typeNames[] = { "buffer", "texture", "renderbuffer", "framebuffer", "shader", "program", "vertex array" };
+
+#ifdef GL_KHR_debug
+static const GLenum identifiers[] = { GL_BUFFER_KHR, GL_TEXTURE, GL_RENDERBUFFER, GL_FRAMEBUFFER, GL_SHADER_KHR, GL_PROGRAM_KHR, GL_VERTEX_ARRAY_KHR };
+#endif
+
+static struct {
+    GlResourceType type;
+    GLuint name;
+    const char* label;
+    size_t bytes;
+} resources[GL_RESOURCES_MAX];
+
+static unsigned resourceCount;
+static char overflowed;
+
+static int find(GlResourceType type, GLuint name) {
+    for (unsigned i = 0; i < resourceCount; i++) {
+        if (resources[i].type == type && resources[i].name == name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+GLuint gl_resources_track(GlResourceType type, GLuint name, const char* label) {
+    if (!name) {
+        return 0;
+    }
+
+    if (resourceCount == GL_RESOURCES_MAX) {
+        if (!overflowed) {
+            fprintf(stderr, "GL: more than %d resources, the rest aren't tracked\n", GL_RESOURCES_MAX);
+            overflowed = 1;
+        }
+        return name;
+    }
+
+    resources[resourceCount].type = type;
+    resources[resourceCount].name = name;
+    resources[resourceCount].label = label;
+    resources[resourceCount].bytes = 0;
+    resourceCount++;
+
+    return name;
+}
+
+void gl_resources_gen(GlResourceType type, GLuint* name, const char* label) {
+    switch (type) {
+        case GL_RESOURCE_BUFFER:       glGenBuffers(1, name); break;
+        case GL_RESOURCE_TEXTURE:      glGenTextures(1, name); break;
+        case GL_RESOURCE_RENDERBUFFER: glGenRenderbuffers(1, name); break;
+        case GL_RESOURCE_FRAMEBUFFER:  glGenFramebuffers(1, name); break;
+#ifdef HAVE_GLES3
+        case GL_RESOURCE_VERTEX_ARRAY: glGenVertexArrays(1, name); break;
+#endif
+        default:
+            // Shaders and programs are created with glCreate*; see
+            // gl_resources_track.
+            *name = 0;
+            return;
+    }
+
+    gl_resources_track(type, *name, label);
+}
+
+void gl_resources_delete(GlResourceType type, GLuint* name) {
+    if (!*name) {
+        return;
+    }
+
+    switch (type) {
+        case GL_RESOURCE_BUFFER:       glDeleteBuffers(1, name); break;
+        case GL_RESOURCE_TEXTURE:      glDeleteTextures(1, name); break;
+        case GL_RESOURCE_RENDERBUFFER: glDeleteRenderbuffers(1, name); break;
+        case GL_RESOURCE_FRAMEBUFFER:  glDeleteFramebuffers(1, name); break;
+        case GL_RESOURCE_SHADER:       glDeleteShader(*name); break;
+        case GL_RESOURCE_PROGRAM:      glDeleteProgram(*name); break;
+#ifdef HAVE_GLES3
+        case GL_RESOURCE_VERTEX_ARRAY: glDeleteVertexArrays(1, name); break;
+#endif
+        default: break;
+    }
+
+    // Order doesn't matter, so the last entry fills the gap.
+    int i = find(type, *name);
+    if (i >= 0) {
+        resources[i] = resources[--resourceCount];
+    }
+
+    *name = 0;
+}
+
+void gl_resources_storage(GlResourceType type, GLuint name, size_t bytes) {
+    int i = find(type, name);
+    if (i >= 0) {
+        resources[i].bytes = bytes;
+    }
+}
+
+unsigned gl_resources_count(GlResourceType type) {
+    unsigned count = 0;
+    for (unsigned i = 0; i < resourceCount; i++) {
+        count += resources[i].type == type;
+    }
+    return count;
+}
+
+size_t gl_resources_bytes() {
+    size_t bytes = 0;
+    for (unsigned i = 0; i < resourceCount; i++) {
+        bytes += resources[i].bytes;
+    }
+    return bytes;
+}
+
+void gl_resources_label() {
+#ifdef GL_KHR_debug
+    for (unsigned i = 0; i < resourceCount; i++) {
+        gl_debug_label(identifiers[resources[i].type], resources[i].name, resources[i].label);
+    }
+#endif
+}
+
+void gl_resources_report() {
+    printf("GL:");
+    for (unsigned type = 0; type < GL_RESOURCE_TYPE_COUNT; type++) {
+        unsigned count = 0;
+        size_t bytes = 0;
+        for (unsigned i = 0; i < resourceCount; i++) {
+            if (resources[i].type == type) {
+                count++;
+                bytes += resources[i].bytes;
+            }
+        }
+        if (count) {
+            printf(" %u %s%s", count, typeNames[type], count == 1 ? "" : "s");
+            if (bytes) {
+                printf(" (%.1f KB)", bytes / 1024.0);
+            }
+            printf(",");
+        }
+    }
+    printf(" %.1f KB estimated in total\n", gl_resources_bytes() / 1024.0);
+}
+
+unsigned gl_resources_report_leaks() {
+    for (unsigned i = 0; i < resourceCount; i++) {
+        fprintf(stderr, "GL: leaked %s %u \"%s\", %zu bytes\n",
+            typeNames[resources[i].type], resources[i].name, resources[i].label, resources[i].bytes);
+    }
+    if (resourceCount) {
+        fprintf(stderr, "GL: %u resources leaked, %.1f KB\n", resourceCount, gl_resources_bytes() / 1024.0);
+    }
+
+    return resourceCount;
+}
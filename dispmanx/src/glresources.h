@@ -0,0 +1,65 @@
+#ifndef GLRESOURCES_H
+#define GLRESOURCES_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "GLES2/gl2.h"
+#ifdef HAVE_GLES3
+#include "GLES3/gl3.h"
+#endif
+
+#include "global.h"
+#include "gldebug.h"
+
+#define GL_RESOURCES_MAX                                              64
+
+typedef enum {
+    GL_RESOURCE_BUFFER,
+    GL_RESOURCE_TEXTURE,
+    GL_RESOURCE_RENDERBUFFER,
+    GL_RESOURCE_FRAMEBUFFER,
+    GL_RESOURCE_SHADER,
+    GL_RESOURCE_PROGRAM,
+    GL_RESOURCE_VERTEX_ARRAY,
+    GL_RESOURCE_TYPE_COUNT
+} GlResourceType;
+
+// The registry of every GL object the program holds, with the GPU memory
+// each is estimated to take. Objects are created and deleted through it;
+// anything still registered at shutdown is reported as a leak. Only the
+// thread with the context current may call these, so there is no locking,
+// and the table is fixed so that nothing here allocates.
+
+// Creates one object with glGen* and registers it under label, a string
+// literal.
+void gl_resources_gen(GlResourceType type, GLuint* name, const char* label);
+
+// Registers an object created by glCreateShader or glCreateProgram.
+GLuint gl_resources_track(GlResourceType type, GLuint name, const char* label);
+
+// Deletes the object with glDelete* and sets *name to 0. Names of 0 are
+// ignored, as GL does.
+void gl_resources_delete(GlResourceType type, GLuint* name);
+
+// Records the estimated size of an object's storage, replacing any earlier
+// estimate; call it after glBufferData, glTexImage2D or glRenderbufferStorage.
+void gl_resources_storage(GlResourceType type, GLuint name, size_t bytes);
+
+unsigned gl_resources_count(GlResourceType type);
+size_t gl_resources_bytes();
+
+// Gives every registered object its label for KHR_debug messages. GL only
+// creates an object when its name is first bound, so call this once setup
+// is done.
+void gl_resources_label();
+
+// Prints the live count and estimated size of each kind of object.
+void gl_resources_report();
+
+// Prints every object still registered and returns how many there are.
+unsigned gl_resources_report_leaks();
+
+#endif // GLRESOURCES_H
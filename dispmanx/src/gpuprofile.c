@@ -0,0 +1,151 @@
+#include "gpuprofile.h"
+
+GpuProfile* gpu_profile_init(GpuProfile* p) {
+    GpuProfile* profile = p ? p : NEW(GpuProfile, 1);
+    memset(profile, 0, sizeof(GpuProfile));
+
+#ifdef GL_EXT_disjoint_timer_query
+    const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+    if (extensions && strstr(extensions, "GL_EXT_disjoint_timer_query")) {
+        profile->genQueries = (PFNGLGENQUERIESEXTPROC)eglGetProcAddress("glGenQueriesEXT");
+        profile->deleteQueries = (PFNGLDELETEQUERIESEXTPROC)eglGetProcAddress("glDeleteQueriesEXT");
+        profile->beginQuery = (PFNGLBEGINQUERYEXTPROC)eglGetProcAddress("glBeginQueryEXT");
+        profile->endQuery = (PFNGLENDQUERYEXTPROC)eglGetProcAddress("glEndQueryEXT");
+        profile->getQueryObjectuiv = (PFNGLGETQUERYOBJECTUIVEXTPROC)eglGetProcAddress("glGetQueryObjectuivEXT");
+        profile->getQueryObjectui64v = (PFNGLGETQUERYOBJECTUI64VEXTPROC)eglGetProcAddress("glGetQueryObjectui64vEXT");
+
+        profile->supported = profile->genQueries && profile->deleteQueries &&
+            profile->beginQuery && profile->endQuery &&
+            profile->getQueryObjectuiv && profile->getQueryObjectui64v;
+    }
+
+    if (profile->supported) {
+        profile->genQueries(GPU_PROFILE_LATENCY * GPU_PROFILE_MAX_PASSES, &profile->queries[0][0]);
+
+        // Clear any disjoint state left from before the first frame.
+        GLint disjoint;
+        glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+
+        glCheck();
+    }
+#endif
+
+    if (!profile->supported) {
+        printf("GPU profile: GL_EXT_disjoint_timer_query not available, passes are not timed\n");
+    }
+
+    return profile;
+}
+
+void gpu_profile_destroy(GpuProfile* profile) {
+#ifdef GL_EXT_disjoint_timer_query
+    if (profile->supported) {
+        profile->deleteQueries(GPU_PROFILE_LATENCY * GPU_PROFILE_MAX_PASSES, &profile->queries[0][0]);
+    }
+#endif
+}
+
+#ifdef GL_EXT_disjoint_timer_query
+static int pass_index(GpuProfile* profile, const char* pass) {
+    for (unsigned i = 0; i < profile->passCount; i++) {
+        if (profile->passes[i] == pass) {
+            return i;
+        }
+    }
+
+    if (profile->passCount == GPU_PROFILE_MAX_PASSES) {
+        return -1;
+    }
+
+    profile->passes[profile->passCount] = pass;
+    return profile->passCount++;
+}
+#endif
+
+void gpu_profile_begin(GpuProfile* profile, const char* pass) {
+#ifdef GL_EXT_disjoint_timer_query
+    if (!profile->supported) {
+        return;
+    }
+
+    int i = pass_index(profile, pass);
+    if (i < 0) {
+        return;
+    }
+
+    profile->beginQuery(GL_TIME_ELAPSED_EXT, profile->queries[profile->slot][i]);
+    profile->pending[profile->slot][i] = 1;
+    profile->timing = 1;
+#endif
+}
+
+void gpu_profile_end(GpuProfile* profile) {
+#ifdef GL_EXT_disjoint_timer_query
+    if (!profile->timing) {
+        return;
+    }
+
+    profile->endQuery(GL_TIME_ELAPSED_EXT);
+    profile->timing = 0;
+#endif
+}
+
+void gpu_profile_frame(GpuProfile* profile) {
+#ifdef GL_EXT_disjoint_timer_query
+    if (!profile->supported) {
+        return;
+    }
+
+    // The next slot holds the oldest frame's queries; collect them before
+    // they are reused.
+    profile->slot = (profile->slot + 1) % GPU_PROFILE_LATENCY;
+
+    // A disjoint event (e.g. a clock change) makes every result in flight
+    // meaningless.
+    GLint disjoint = 0;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+
+    for (unsigned i = 0; i < profile->passCount; i++) {
+        if (!profile->pending[profile->slot][i]) {
+            continue;
+        }
+        profile->pending[profile->slot][i] = 0;
+
+        GLuint query = profile->queries[profile->slot][i];
+        GLuint available = 0;
+        profile->getQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE_EXT, &available);
+
+        if (!available || disjoint) {
+            profile->discarded++;
+            continue;
+        }
+
+        GLuint64 nanos;
+        profile->getQueryObjectui64v(query, GL_QUERY_RESULT_EXT, &nanos);
+
+        profile->reportMillis[i] += nanos / 1e6;
+        profile->reportSamples[i]++;
+    }
+
+    glCheck();
+
+    if (++profile->reportFrames == GPU_PROFILE_REPORT_FRAMES) {
+        printf("GPU profile:");
+        for (unsigned i = 0; i < profile->passCount; i++) {
+            if (profile->reportSamples[i]) {
+                printf(" %s %.3f ms", profile->passes[i], profile->reportMillis[i] / profile->reportSamples[i]);
+            }
+            profile->reportMillis[i] = 0;
+            profile->reportSamples[i] = 0;
+        }
+        printf(" over %u frames", profile->reportFrames);
+        if (profile->discarded) {
+            printf(", %u discarded", profile->discarded);
+        }
+        printf("\n");
+
+        profile->reportFrames = 0;
+        profile->discarded = 0;
+    }
+#endif
+}
@@ -0,0 +1,60 @@
+#ifndef GPUPROFILE_H
+#define GPUPROFILE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "GLES2/gl2.h"
+#include "GLES2/gl2ext.h"
+#include "EGL/egl.h"
+
+#include "global.h"
+
+#define GPU_PROFILE_MAX_PASSES                                         8
+#define GPU_PROFILE_LATENCY                                            4
+#define GPU_PROFILE_REPORT_FRAMES                                    120
+
+// GPU time per render pass, from GL_EXT_disjoint_timer_query. Each frame's
+// queries go into one slot of a ring and are read back GPU_PROFILE_LATENCY
+// frames later, when they have long finished, so reading never stalls.
+// Without the extension every call does nothing.
+typedef struct {
+    char supported;
+#ifdef GL_EXT_disjoint_timer_query
+    PFNGLGENQUERIESEXTPROC genQueries;
+    PFNGLDELETEQUERIESEXTPROC deleteQueries;
+    PFNGLBEGINQUERYEXTPROC beginQuery;
+    PFNGLENDQUERYEXTPROC endQuery;
+    PFNGLGETQUERYOBJECTUIVEXTPROC getQueryObjectuiv;
+    PFNGLGETQUERYOBJECTUI64VEXTPROC getQueryObjectui64v;
+#endif
+
+    const char* passes[GPU_PROFILE_MAX_PASSES];
+    unsigned passCount;
+
+    GLuint queries[GPU_PROFILE_LATENCY][GPU_PROFILE_MAX_PASSES];
+    char pending[GPU_PROFILE_LATENCY][GPU_PROFILE_MAX_PASSES];
+    unsigned slot;
+    char timing;
+
+    unsigned reportFrames;
+    double reportMillis[GPU_PROFILE_MAX_PASSES];
+    unsigned reportSamples[GPU_PROFILE_MAX_PASSES];
+    unsigned discarded;
+} GpuProfile;
+
+GpuProfile* gpu_profile_init(GpuProfile* p);
+void gpu_profile_destroy(GpuProfile* profile);
+
+// Bracket one pass. Passes are told apart by the name pointer, so use string
+// literals; they must not nest.
+void gpu_profile_begin(GpuProfile* profile, const char* pass);
+void gpu_profile_end(GpuProfile* profile);
+
+// Call once all of a frame's passes are submitted: reads back the oldest
+// slot, prints the mean GPU time per pass periodically, and moves on.
+void gpu_profile_frame(GpuProfile* profile);
+
+#endif // GPUPROFILE_H
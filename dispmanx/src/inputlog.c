@@ -0,0 +1,238 @@
+#include "inputlog.h"
+
+static const char* deviceNames[] = { "keyboard", "mouse" };
+
+static FILE* file;
+static char recording;
+static char replaying;
+static uint32_t devices;
+static uint32_t frames;
+
+// Recording: when it started. Replay: when frame 0 started, and its
+// recorded time.
+static struct timespec start;
+static uint64_t startMicros;
+static float speed;
+
+// Replay: one pipe per recorded device, opened by the input modules through
+// /dev/fd, and the record to deliver next.
+static int pipes[INPUT_LOG_DEVICE_COUNT][2];
+static char pipePaths[INPUT_LOG_DEVICE_COUNT][32];
+static InputLogRecord next;
+static char hasNext;
+
+static uint64_t micros_since(const struct timespec* t) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - t->tv_sec) * 1000000ull + (now.tv_nsec - t->tv_nsec) / 1000;
+}
+
+static void write_record(InputLogDevice device, uint64_t micros, uint32_t frame, uint16_t type, uint16_t code, int32_t value) {
+    InputLogRecord record;
+    memset(&record, 0, sizeof(record));
+    record.micros = micros;
+    record.frame = frame;
+    record.device = device;
+    record.type = type;
+    record.code = code;
+    record.value = value;
+
+    fwrite(&record, sizeof(record), 1, file);
+}
+
+static char read_record() {
+    return fread(&next, sizeof(next), 1, file) == 1;
+}
+
+static void deliver(const InputLogRecord* record) {
+    // Stamped now on the realtime clock, as the kernel would before
+    // EVIOCSCLOCKID, which a pipe doesn't take; the input modules convert,
+    // so input latency still means something in a replay.
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    struct input_event event;
+    memset(&event, 0, sizeof(event));
+    event.time.tv_sec = now.tv_sec;
+    event.time.tv_usec = now.tv_nsec / 1000;
+    event.type = record->type;
+    event.code = record->code;
+    event.value = record->value;
+
+    if (write(pipes[record->device][1], &event, sizeof(event)) != sizeof(event)) {
+        fprintf(stderr, "InputLog: %s event dropped in frame %u\n", deviceNames[record->device], record->frame);
+    }
+}
+
+static void wait_for(uint64_t micros) {
+    if (speed <= 0) {
+        return;
+    }
+
+    uint64_t nanos = (micros - startMicros) / speed * 1000;
+
+    struct timespec until = start;
+    until.tv_sec += nanos / 1000000000;
+    until.tv_nsec += nanos % 1000000000;
+    if (until.tv_nsec >= 1000000000) {
+        until.tv_sec++;
+        until.tv_nsec -= 1000000000;
+    }
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL) == EINTR);
+}
+
+char input_log_record(const char* path, char keyboard, char mouse) {
+    file = fopen(path, "wb");
+    if (!file) {
+        perror("InputLog: unable to create the recording.");
+        return 0;
+    }
+
+    InputLogHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = INPUT_LOG_MAGIC;
+    header.version = INPUT_LOG_VERSION;
+    header.devices = (keyboard ? 1 << INPUT_LOG_KEYBOARD : 0) | (mouse ? 1 << INPUT_LOG_MOUSE : 0);
+
+    // Writing the header now also has stdio allocate its buffer before the
+    // frame loop starts.
+    fwrite(&header, sizeof(header), 1, file);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    recording = 1;
+
+    printf("InputLog: recording to %s\n", path);
+
+    return 1;
+}
+
+char input_log_replay(const char* path, float s) {
+    file = fopen(path, "rb");
+    if (!file) {
+        perror("InputLog: unable to open the recording.");
+        return 0;
+    }
+
+    InputLogHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != INPUT_LOG_MAGIC || header.version != INPUT_LOG_VERSION) {
+        fprintf(stderr, "InputLog: %s is not a version %d input recording.\n", path, INPUT_LOG_VERSION);
+        fclose(file);
+        file = NULL;
+        return 0;
+    }
+
+    devices = header.devices;
+    for (unsigned i = 0; i < INPUT_LOG_DEVICE_COUNT; i++) {
+        if (!(devices & (1 << i))) {
+            continue;
+        }
+
+        if (pipe(pipes[i]) == -1) {
+            perror("InputLog: unable to create a pipe.");
+            return 0;
+        }
+
+        // Never block the frame loop; a full pipe drops the event instead.
+        fcntl(pipes[i][1], F_SETFL, O_NONBLOCK);
+        snprintf(pipePaths[i], sizeof(pipePaths[i]), "/dev/fd/%d", pipes[i][0]);
+    }
+
+    speed = s;
+    hasNext = read_record();
+    replaying = 1;
+
+    if (speed > 0) {
+        printf("InputLog: replaying %s at %gx\n", path, speed);
+    } else {
+        printf("InputLog: replaying %s as fast as possible\n", path);
+    }
+
+    return 1;
+}
+
+const char* input_log_device(InputLogDevice device, const char* devicePath) {
+    if (!replaying) {
+        return devicePath;
+    }
+
+    return devices & (1 << device) ? pipePaths[device] : NULL;
+}
+
+void input_log_event(InputLogDevice device, const struct input_event* event) {
+    if (recording) {
+        write_record(device, micros_since(&start), frames ? frames - 1 : 0, event->type, event->code, event->value);
+    }
+}
+
+char input_log_frame(uint64_t* micros) {
+    *micros = micros_since(&start);
+
+    if (recording) {
+        write_record(INPUT_LOG_FRAME, *micros, frames++, 0, 0, 0);
+        return 1;
+    }
+
+    if (!replaying) {
+        return 1;
+    }
+
+    // A recording cut short ends with its last complete frame.
+    if (!hasNext || (next.device == INPUT_LOG_END && next.frame <= frames)) {
+        return 0;
+    }
+
+    uint32_t frame = frames++;
+
+    while (hasNext && next.frame <= frame && next.device != INPUT_LOG_END) {
+        if (next.device == INPUT_LOG_FRAME) {
+            if (frame == 0) {
+                clock_gettime(CLOCK_MONOTONIC, &start);
+                startMicros = next.micros;
+            }
+            wait_for(next.micros);
+            *micros = next.micros;
+        } else if (next.device < INPUT_LOG_DEVICE_COUNT && devices & (1 << next.device)) {
+            deliver(&next);
+        }
+
+        hasNext = read_record();
+    }
+
+    return 1;
+}
+
+struct timeval input_log_monotonic_time(struct timeval realtime) {
+    struct timespec nowRealtime, nowMonotonic;
+    clock_gettime(CLOCK_REALTIME, &nowRealtime);
+    clock_gettime(CLOCK_MONOTONIC, &nowMonotonic);
+
+    int64_t offsetMicros = (int64_t)(nowRealtime.tv_sec - nowMonotonic.tv_sec) * 1000000 + (nowRealtime.tv_nsec - nowMonotonic.tv_nsec) / 1000;
+    int64_t micros = (int64_t)realtime.tv_sec * 1000000 + realtime.tv_usec - offsetMicros;
+
+    struct timeval monotonic = { micros / 1000000, micros % 1000000 };
+    return monotonic;
+}
+
+void input_log_close() {
+    if (recording) {
+        write_record(INPUT_LOG_END, micros_since(&start), frames, 0, 0, 0);
+        fclose(file);
+        recording = 0;
+
+        printf("InputLog: recorded %u frames\n", frames);
+    }
+
+    if (replaying) {
+        fclose(file);
+        for (unsigned i = 0; i < INPUT_LOG_DEVICE_COUNT; i++) {
+            if (devices & (1 << i)) {
+                close(pipes[i][0]);
+                close(pipes[i][1]);
+            }
+        }
+        replaying = 0;
+
+        printf("InputLog: replayed %u frames\n", frames);
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef INPUTLOG_H
+#define INPUTLOG_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <linux/input.h>
+
+#include "global.h"
+
+#define INPUT_LOG_MAGIC                                       0x52495448 // "HTIR"
+#define INPUT_LOG_VERSION                                              1
+
+typedef enum {
+    INPUT_LOG_KEYBOARD,
+    INPUT_LOG_MOUSE,
+    INPUT_LOG_DEVICE_COUNT,
+
+    // Not devices: the start of a frame, and the end of the recording, whose
+    // frame is the number of frames recorded.
+    INPUT_LOG_FRAME = INPUT_LOG_DEVICE_COUNT,
+    INPUT_LOG_END
+} InputLogDevice;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t devices;       // 1 << InputLogDevice for each device recorded
+    uint32_t reserved;
+} InputLogHeader;
+
+// An evdev event as read by keyboard_process_events or mouse_process_events,
+// with the frame that read it; or a frame's start.
+typedef struct {
+    uint64_t micros;        // since recording started
+    uint32_t frame;
+    int32_t value;
+    uint16_t type;
+    uint16_t code;
+    uint8_t device;
+    uint8_t reserved[3];
+} InputLogRecord;
+
+// Records the input the simulation reads, or plays a recording back in its
+// place. Frames here are the simulation's ticks. A replay hands each event
+// to the tick that read it, whatever the timing, so every run simulates
+// the same; it ends after the recorded number of ticks. Ticks start at the
+// recorded times divided by the replay speed, or as fast as they can with
+// a speed of 0.
+
+// Starts recording to path, noting which devices are open. Returns 0 if the
+// file can't be created.
+char input_log_record(const char* path, char keyboard, char mouse);
+
+// Opens the recording at path for replay. Returns 0 if it can't be read.
+char input_log_replay(const char* path, float speed);
+
+// The device to open for devicePath: devicePath itself, or when replaying,
+// a pipe the recorded events are written into, or NULL if the recording
+// was made without it.
+const char* input_log_device(InputLogDevice device, const char* devicePath);
+
+// Called by the input modules for every event they read.
+void input_log_event(InputLogDevice device, const struct input_event* event);
+
+// Called at the start of every tick. Sets *micros to the frame's start
+// time in microseconds, or in a replay to the recorded one, so that
+// anything timed by it runs as it did. Returns 0 once a replay is over.
+char input_log_frame(uint64_t* micros);
+
+// An event time on CLOCK_REALTIME, the evdev default, moved to
+// CLOCK_MONOTONIC by the current offset between the two.
+struct timeval input_log_monotonic_time(struct timeval realtime);
+
+// Ends a recording or replay.
+void input_log_close();
+
+#endif // INPUTLOG_H
@@ -0,0 +1,48 @@
+#include "instances.h"
+
+Instances* instances_init(Instances* i, unsigned count) {
+    Instances* instances = i ? i : NEW(Instances, 1);
+
+    instances->count = count > 0 ? count : 1;
+    instances->columns = (unsigned)ceil(sqrt(instances->count));
+    instances->offsets = NEW(GLfloat, 3 * instances->count);
+    instances->transforms = NEW(GLfloat, 16 * instances->count);
+
+    unsigned rows = (instances->count + instances->columns - 1) / instances->columns;
+
+    for (unsigned k = 0; k < instances->count; k++) {
+        GLfloat* offset = &instances->offsets[3 * k];
+
+        offset[0] = ((k % instances->columns) + 0.5f) / instances->columns * 2 - 1;
+        offset[1] = 1 - ((k / instances->columns) + 0.5f) / rows * 2;
+        offset[2] = 0;
+    }
+
+    return instances;
+}
+
+void instances_update(Instances* instances, const GLfloat* model) {
+    instances_update_range(instances, model, 0, instances->count);
+}
+
+void instances_update_range(Instances* instances, const GLfloat* model, unsigned begin, unsigned end) {
+    GLfloat scale = 1.0f / instances->columns;
+
+    // translate(offset) * scale(1/columns) * model, expanded so no temporary
+    // matrices are needed per instance.
+    for (unsigned k = begin; k < end; k++) {
+        const GLfloat* offset = &instances->offsets[3 * k];
+        GLfloat* transform = &instances->transforms[16 * k];
+
+        for (unsigned c = 0; c < 4; c++) {
+            for (unsigned r = 0; r < 3; r++)
+                transform[c*4+r] = scale * model[c*4+r] + offset[r] * model[c*4+3];
+            transform[c*4+3] = model[c*4+3];
+        }
+    }
+}
+
+void instances_destroy(Instances* instances) {
+    free(instances->transforms);
+    free(instances->offsets);
+}
@@ -0,0 +1,27 @@
+#ifndef INSTANCES_H
+#define INSTANCES_H
+
+#include <stdlib.h>
+#include <math.h>
+#include "GLES2/gl2.h"
+
+#include "global.h"
+
+// Copies of the triangle laid out in a square grid that fills clip space.
+// Each instance's transform is the shared model matrix, scaled down to its
+// cell and moved to the cell's centre.
+typedef struct {
+    unsigned count;
+    unsigned columns;
+    GLfloat* offsets;       // vec3 per instance
+    GLfloat* transforms;    // column-major mat4 per instance
+} Instances;
+
+Instances* instances_init(Instances* i, unsigned count);
+void instances_update(Instances* instances, const GLfloat* model);
+
+// Updates instances [begin, end) only; ranges can be updated in parallel.
+void instances_update_range(Instances* instances, const GLfloat* model, unsigned begin, unsigned end);
+void instances_destroy(Instances* instances);
+
+#endif // INSTANCES_H
@@ -0,0 +1,44 @@
+#include "jitter.h"
+
+static int compare_floats(const void* a, const void* b) {
+    float x = *(const float*)a;
+    float y = *(const float*)b;
+
+    return (x > y) - (x < y);
+}
+
+static float percentile(const float* sorted, unsigned count, float p) {
+    unsigned rank = p * count;
+    return sorted[rank < count ? rank : count - 1];
+}
+
+Jitter* jitter_init(Jitter* j) {
+    Jitter* jitter = j ? j : NEW(Jitter, 1);
+
+    memset(jitter, 0, sizeof(Jitter));
+
+    return jitter;
+}
+
+void jitter_frame(Jitter* jitter, float millis) {
+    jitter->millis[jitter->next] = millis;
+    jitter->next = (jitter->next + 1) % JITTER_FRAMES;
+    if (jitter->count < JITTER_FRAMES) {
+        jitter->count++;
+    }
+}
+
+void jitter_report(Jitter* jitter, const char* mode) {
+    if (!jitter->count) {
+        return;
+    }
+
+    memcpy(jitter->sorted, jitter->millis, jitter->count * sizeof(float));
+    qsort(jitter->sorted, jitter->count, sizeof(float), compare_floats);
+
+    float p50 = percentile(jitter->sorted, jitter->count, 0.50f);
+    float p99 = percentile(jitter->sorted, jitter->count, 0.99f);
+
+    printf("Jitter: %s, %s%u frames, p50 %.3f ms, p99 %.3f ms, p99-p50 %.3f ms\n", mode,
+        jitter->count == JITTER_FRAMES ? "last " : "", jitter->count, p50, p99, p99 - p50);
+}
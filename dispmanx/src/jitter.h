@@ -0,0 +1,30 @@
+#ifndef JITTER_H
+#define JITTER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "global.h"
+
+// Frames kept: a little over a minute at 60 Hz.
+#define JITTER_FRAMES                                               4096
+
+// Frame-to-frame jitter: the gap between the 99th percentile and the median
+// of the swap-to-swap times. The buffers are sized up front, so recording a
+// frame never allocates.
+typedef struct {
+    float millis[JITTER_FRAMES];
+    float sorted[JITTER_FRAMES];
+    unsigned count;
+    unsigned next;
+} Jitter;
+
+Jitter* jitter_init(Jitter* j);
+void jitter_frame(Jitter* jitter, float millis);
+
+// Prints the median, the 99th percentile and their difference over the
+// frames kept, tagged with mode to tell runs apart.
+void jitter_report(Jitter* jitter, const char* mode);
+
+#endif // JITTER_H
@@ -0,0 +1,258 @@
+#include "jobs.h"
+#include "trace.h"
+
+#define JOBS_MASK                                  (JOBS_PER_WORKER - 1)
+
+// The calling thread's worker, if it is one.
+static __thread JobWorker* self;
+
+static void futex_wait(void* address, uint32_t value) {
+    syscall(SYS_futex, address, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+}
+
+static void futex_wake(void* address) {
+    syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
+
+static void publish(JobSystem* jobs) {
+    // Sequentially consistent against the sleeper count's increment: a
+    // worker either is counted here or reads the new wake before sleeping.
+    __atomic_add_fetch(&jobs->wake, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&jobs->sleepers, __ATOMIC_SEQ_CST)) {
+        futex_wake(&jobs->wake);
+    }
+}
+
+// Deque: the owner pushes and pops at the bottom, thieves take from the top.
+
+static void push(JobWorker* worker, Job* job) {
+    long bottom = __atomic_load_n(&worker->bottom, __ATOMIC_RELAXED);
+    __atomic_store_n(&worker->deque[bottom & JOBS_MASK], job, __ATOMIC_RELAXED);
+    __atomic_store_n(&worker->bottom, bottom + 1, __ATOMIC_RELEASE);
+}
+
+static Job* pop(JobWorker* worker) {
+    long bottom = __atomic_load_n(&worker->bottom, __ATOMIC_RELAXED) - 1;
+    __atomic_store_n(&worker->bottom, bottom, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    long top = __atomic_load_n(&worker->top, __ATOMIC_RELAXED);
+
+    if (top > bottom) {
+        __atomic_store_n(&worker->bottom, bottom + 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+
+    Job* job = __atomic_load_n(&worker->deque[bottom & JOBS_MASK], __ATOMIC_RELAXED);
+    if (top == bottom) {
+        // The last job; a thief may be taking it at the same time.
+        if (!__atomic_compare_exchange_n(&worker->top, &top, top + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+            job = NULL;
+        }
+        __atomic_store_n(&worker->bottom, bottom + 1, __ATOMIC_RELAXED);
+    }
+
+    return job;
+}
+
+static Job* steal(JobWorker* worker) {
+    long top = __atomic_load_n(&worker->top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    long bottom = __atomic_load_n(&worker->bottom, __ATOMIC_ACQUIRE);
+
+    if (top >= bottom) {
+        return NULL;
+    }
+
+    Job* job = __atomic_load_n(&worker->deque[top & JOBS_MASK], __ATOMIC_RELAXED);
+    if (!__atomic_compare_exchange_n(&worker->top, &top, top + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+        return NULL;
+    }
+
+    return job;
+}
+
+// Jobs
+
+static void finish(Job* job) {
+    Job* parent = job->parent;
+
+    int unfinished = __atomic_sub_fetch(&job->unfinished, 1, __ATOMIC_ACQ_REL);
+    if (unfinished == JOBS_ROOT_SLEEPING) {
+        // A root whose caller sleeps on it; only the address is used, so
+        // it doesn't matter if the caller has already returned.
+        futex_wake(&job->unfinished);
+    } else if (unfinished == 0 && parent) {
+        finish(parent);
+    }
+}
+
+static void run(Job* job) {
+    TRACE_SCOPE("job");
+
+    job->function(job->data, job->begin, job->end);
+    finish(job);
+}
+
+static Job* find_job(JobSystem* jobs, JobWorker* worker) {
+    Job* job = pop(worker);
+    if (job) {
+        return job;
+    }
+
+    // xorshift32: victims in a different order each time, so that thieves
+    // don't all queue up on the same deque.
+    worker->random ^= worker->random << 13;
+    worker->random ^= worker->random >> 17;
+    worker->random ^= worker->random << 5;
+
+    unsigned start = worker->random % jobs->workerCount;
+    for (unsigned i = 0; i < jobs->workerCount; i++) {
+        JobWorker* victim = &jobs->workers[(start + i) % jobs->workerCount];
+        if (victim != worker && (job = steal(victim))) {
+            return job;
+        }
+    }
+
+    return NULL;
+}
+
+static void* work(void* arg) {
+    JobWorker* worker = arg;
+    JobSystem* jobs = worker->system;
+
+    self = worker;
+    trace_thread_name("jobs");
+    if (jobs->realtime) {
+        realtime_thread(jobs->realtime, "jobs", realtime_job_cpu(jobs->realtime, worker - jobs->workers), REALTIME_JOBS_PRIORITY);
+    }
+
+    while (!__atomic_load_n(&jobs->stop, __ATOMIC_ACQUIRE)) {
+        uint32_t wake = __atomic_load_n(&jobs->wake, __ATOMIC_ACQUIRE);
+
+        Job* job = find_job(jobs, worker);
+        if (job) {
+            run(job);
+            continue;
+        }
+
+        // Work published since wake was read has moved it on, and then
+        // this returns at once.
+        __atomic_add_fetch(&jobs->sleepers, 1, __ATOMIC_SEQ_CST);
+        futex_wait(&jobs->wake, wake);
+        __atomic_sub_fetch(&jobs->sleepers, 1, __ATOMIC_RELAXED);
+    }
+
+    return NULL;
+}
+
+JobSystem* jobs_init(JobSystem* j, unsigned workerCount, RealTime* realtime) {
+    JobSystem* jobs = j ? j : NEW(JobSystem, 1);
+
+    memset(jobs, 0, sizeof(JobSystem));
+    jobs->realtime = realtime;
+
+    if (!workerCount) {
+        workerCount = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    jobs->workerCount = workerCount < JOBS_MAX_WORKERS ? workerCount : JOBS_MAX_WORKERS;
+
+    for (unsigned i = 0; i < jobs->workerCount; i++) {
+        jobs->workers[i].system = jobs;
+        jobs->workers[i].random = 2654435761u * (i + 1);
+    }
+
+    self = &jobs->workers[0];
+    for (unsigned i = 1; i < jobs->workerCount; i++) {
+        pthread_create(&jobs->threads[i], NULL, work, &jobs->workers[i]);
+    }
+
+    return jobs;
+}
+
+void jobs_destroy(JobSystem* jobs) {
+    __atomic_store_n(&jobs->stop, 1, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&jobs->wake, 1, __ATOMIC_SEQ_CST);
+    futex_wake(&jobs->wake);
+
+    for (unsigned i = 1; i < jobs->workerCount; i++) {
+        pthread_join(jobs->threads[i], NULL);
+    }
+
+    if (self == &jobs->workers[0]) {
+        self = NULL;
+    }
+    jobs->workerCount = 0;
+}
+
+void jobs_parallel_for(JobSystem* jobs, unsigned count, unsigned grain, JobFunction function, void* data) {
+    JobWorker* worker = self;
+
+    if (!grain) {
+        grain = 1;
+    }
+
+    unsigned chunks = count / grain + (count % grain != 0);
+    if (chunks > JOBS_MAX_CHUNKS) {
+        chunks = JOBS_MAX_CHUNKS;
+    }
+
+    if (chunks <= 1 || jobs->workerCount <= 1 || !worker || worker->system != jobs) {
+        if (count) {
+            function(data, 0, count);
+        }
+        return;
+    }
+
+    // The root only counts its children, so it can live on the stack: this
+    // doesn't return before they are all done.
+    Job root;
+    memset(&root, 0, sizeof(root));
+    root.unfinished = chunks + 1;
+
+    for (unsigned c = 0; c < chunks; c++) {
+        Job* job = &worker->pool[worker->allocated & JOBS_MASK];
+
+        // Waiting workers run other jobs, which may wait in turn; nested
+        // deep enough, the pool wraps onto jobs still in flight. The rest
+        // of the range then runs here.
+        if (__atomic_load_n(&job->unfinished, __ATOMIC_ACQUIRE)) {
+            function(data, (uint64_t)count * c / chunks, count);
+            __atomic_sub_fetch(&root.unfinished, chunks - c, __ATOMIC_ACQ_REL);
+            break;
+        }
+
+        worker->allocated++;
+        job->function = function;
+        job->data = data;
+        job->begin = (uint64_t)count * c / chunks;
+        job->end = (uint64_t)count * (c + 1) / chunks;
+        job->parent = &root;
+        job->unfinished = 1;
+
+        push(worker, job);
+    }
+
+    publish(jobs);
+
+    finish(&root);
+
+    // Help rather than wait: run this deque's jobs, or steal others'. With
+    // nothing left to take, sleep until the last child finishes the root;
+    // yielding instead would never let a worker of lower real-time
+    // priority on this CPU run.
+    int unfinished;
+    while ((unfinished = __atomic_load_n(&root.unfinished, __ATOMIC_ACQUIRE)) & ~JOBS_ROOT_SLEEPING) {
+        Job* job = find_job(jobs, worker);
+        if (job) {
+            run(job);
+            continue;
+        }
+
+        // Finishing children see the flag and wake this; one finishing
+        // in between changes the count, and the wait returns at once.
+        unfinished = __atomic_or_fetch(&root.unfinished, JOBS_ROOT_SLEEPING, __ATOMIC_ACQ_REL);
+        if (unfinished != JOBS_ROOT_SLEEPING) {
+            futex_wait(&root.unfinished, unfinished);
+        }
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sched.h>
+#include <limits.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "global.h"
+#include "realtime.h"
+
+#define JOBS_MAX_WORKERS                                              16
+
+// Jobs each worker's pool and deque hold; a power of two. A parallel for
+// splits into at most JOBS_MAX_CHUNKS, so a few can nest before a worker's
+// pool runs out; beyond that, ranges run on the calling thread.
+#define JOBS_PER_WORKER                                              256
+#define JOBS_MAX_CHUNKS                                               64
+
+// Set in a parallel for's root count while its caller sleeps on it.
+#define JOBS_ROOT_SLEEPING                                       0x40000000
+
+typedef void (*JobFunction)(void* data, unsigned begin, unsigned end);
+
+// A range of a parallel for. unfinished counts the job itself and each
+// child not yet done; the last to finish finishes the parent in turn.
+typedef struct Job {
+    JobFunction function;
+    void* data;
+    unsigned begin;
+    unsigned end;
+    struct Job* parent;
+    int unfinished;
+} Job;
+
+// One per thread. The owner pushes and pops at the bottom of its deque
+// (Chase-Lev, fixed size); idle workers steal from the top. Jobs come from
+// the owner's pool, reused in turn, so submitting never allocates.
+typedef struct {
+    struct JobSystem* system;
+
+    long top;
+    long bottom;
+    Job* deque[JOBS_PER_WORKER];
+
+    Job pool[JOBS_PER_WORKER];
+    unsigned allocated;
+
+    uint32_t random;
+} __attribute__((aligned(64))) JobWorker;
+
+// A work-stealing pool of threads for CPU work within a stage of the
+// frame. The thread that creates it is worker 0 and works on its own jobs
+// while it waits for them; the others sleep until there is work. Without
+// jobs_init, or with one worker, everything runs on the calling thread.
+typedef struct JobSystem {
+    JobWorker workers[JOBS_MAX_WORKERS];
+    unsigned workerCount;
+    pthread_t threads[JOBS_MAX_WORKERS];
+    RealTime* realtime;
+
+    // Bumped whenever work is published or the pool stops; sleeping
+    // workers wait on it with a futex, counted in sleepers so that
+    // publishing only makes a syscall when one is asleep.
+    uint32_t wake;
+    uint32_t sleepers;
+    char stop;
+} JobSystem;
+
+// Starts workerCount - 1 threads; 0 means one per CPU. Under realtime, each
+// runs at the render thread's priority on a CPU of its own where there are
+// enough, never the simulation's.
+JobSystem* jobs_init(JobSystem* j, unsigned workerCount, RealTime* realtime);
+void jobs_destroy(JobSystem* jobs);
+
+// Calls function on subranges of [0, count) of at least grain items in
+// parallel, and returns when all are done. Callable from worker 0 and from
+// within jobs.
+void jobs_parallel_for(JobSystem* jobs, unsigned count, unsigned grain, JobFunction function, void* data);
+
+#endif // JOBS_H
@@ -1,4 +1,6 @@
 #include "keyboard.h"
+#include "trace.h"
+#include "inputlog.h"
 
 Keyboard* keyboard_init(Keyboard* k, const char* devicePath) {
     Keyboard* keyboard = k ? k : NEW(Keyboard, 1);
@@ -8,9 +10,23 @@ Keyboard* keyboard_init(Keyboard* k, const char* devicePath) {
     keyboard->fd = open(devicePath, O_RDONLY | O_NONBLOCK);
     if (keyboard->fd == -1) {
         perror("Keyboard: unable to open device.");
+        if (!k) {
+            free(keyboard);
+        }
         return NULL;
     }
 
+    // Event times are on the realtime clock by default, which can jump.
+    int clockId = CLOCK_MONOTONIC;
+    if (ioctl(keyboard->fd, EVIOCSCLOCKID, &clockId) == -1) {
+        // ENOTTY is a replay's pipe, not a device; its events are stamped
+        // on the realtime clock too.
+        if (errno != ENOTTY) {
+            fprintf(stderr, "Keyboard: unable to set the event clock (%s), converting from CLOCK_REALTIME\n", strerror(errno));
+        }
+        keyboard->realtimeClock = 1;
+    }
+
     return keyboard;
 }
 
@@ -19,9 +35,13 @@ void keyboard_destroy(Keyboard* keyboard) {
 }
 
 void keyboard_process_events(Keyboard* keyboard) {
+    TRACE_SCOPE("keyboard_process_events");
+
     int n;
     struct input_event inputEvent;
     while ((n = read(keyboard->fd, (void*)&inputEvent, sizeof(struct input_event))) > 0) {
+        input_log_event(INPUT_LOG_KEYBOARD, &inputEvent);
+        keyboard->lastEvent = keyboard->realtimeClock ? input_log_monotonic_time(inputEvent.time) : inputEvent.time;
         if (inputEvent.type == EV_KEY && inputEvent.value != 2) {     
             keyboard->keys[inputEvent.code] = inputEvent.value;
         }
@@ -6,6 +6,10 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/ioctl.h>
+#include <sys/time.h>
 #include <linux/input.h>
 
 #include "global.h"
@@ -13,6 +17,13 @@
 typedef struct {
     int fd;
     char keys[255];
+
+    // Time of the latest event, on CLOCK_MONOTONIC
+    struct timeval lastEvent;
+
+    // Set when the device wouldn't switch clocks, so event times are on
+    // CLOCK_REALTIME and are converted.
+    char realtimeClock;
 } Keyboard;
 
 Keyboard* keyboard_init(Keyboard* k, const char* devicePath);
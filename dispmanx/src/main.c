@@ -1,25 +1,83 @@
 #include <sys/time.h>
+#include <pthread.h>
+#include <sched.h>
 #include <cairo/cairo.h>
 
 #include "keyboard.h"
 #include "mouse.h"
 #include "window.h"
 #include "matrix.h"
+#include "programcache.h"
+#include "startup.h"
+#include "instances.h"
+#include "resolution.h"
+#include "antialias.h"
+#include "gpuprofile.h"
+#include "perfcounters.h"
+#include "alloctrack.h"
+#include "metrics.h"
+#include "glresources.h"
+#include "gldebug.h"
+#include "inputlog.h"
+#include "simclock.h"
+#include "scene.h"
+#include "realtime.h"
+#include "jitter.h"
+#include "jobs.h"
+#include "trace.h"
 
 #define DEGREES_TO_RADIANS(d)                       (d * 2 * M_PI / 360)
 
+#define ANIMATION_DEGREES_PER_SECOND                                  60
+
+// Instances per job when transforms are computed in parallel, and the
+// --jobs-benchmark workload.
+#define INSTANCES_GRAIN                                              256
+#define JOBS_BENCHMARK_INSTANCES                                   65536
+#define JOBS_BENCHMARK_ITERATIONS                                    200
+
 #define TEXT_WIDTH                                                   524
 #define TEXT_HEIGHT                                                   32
 #define FPS_WIDTH                                                    128
 #define FPS_HEIGHT                                                    16
 
 Window* window;
+Keyboard* keyboard;
+Mouse* mouse;
 
 GLfloat X[] = { 1, 0, 0 };
 GLfloat Y[] = { 0, 1, 0 };
 GLfloat Z[] = { 0, 0, 1 };
 
+// The simulation's state after its latest step and the one before, which
+// only the simulation thread touches, and what the renderer draws: the two
+// blended by how far the clock is into the next step.
 GLfloat rotation[] = {0, 0, 0};
+GLfloat previousRotation[] = {0, 0, 0};
+GLfloat drawnRotation[] = {0, 0, 0};
+
+SimClock simClock;
+
+// Input and animation run on their own thread, a tick per simulation step,
+// and publish a scene each tick; the render loop draws the newest, so a
+// swap that blocks never holds up input. A replay runs the two in lockstep
+// instead, each tick drawn once, so that every run renders the same frames.
+SceneBuffer sceneBuffer;
+char lockstep;
+char quit;                  // set by either thread to stop both
+uint32_t drawnSequence;     // of the latest scene swapped to the screen
+
+// In lockstep each thread sleeps here until the other has published or
+// drawn a tick, rather than yielding, which would never let a lower
+// real-time priority sharing its CPU run.
+pthread_mutex_t lockstepMutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t lockstepCondition = PTHREAD_COND_INITIALIZER;
+
+void lockstep_signal() {
+    pthread_mutex_lock(&lockstepMutex);
+    pthread_cond_broadcast(&lockstepCondition);
+    pthread_mutex_unlock(&lockstepMutex);
+}
 
 // Shader: triangle
 
@@ -38,14 +96,13 @@ const GLchar* triangle_vshader_source =
     "}";
 
 const GLchar* triangle_fshader_source = 
+    "precision mediump float;"
     "varying vec3 Color;"
 
     "void main() {"
     " gl_FragColor = vec4(Color, 1.0);"
     "}";
 
-GLuint triangleVertexShader;
-GLuint triangleFragmentShader;
 GLuint triangleProgram;
 
 // Shader: text & FPS
@@ -65,6 +122,7 @@ const GLchar* text_vshader_source =
     "}";
 
 const GLchar* text_fshader_source = 
+    "precision mediump float;"
     "varying vec2 Texcoord;"
 
     "uniform sampler2D tex;"
@@ -72,70 +130,157 @@ const GLchar* text_fshader_source =
     " gl_FragColor = texture2D(tex, Texcoord).bgra;\n"
     "}";
 
-GLuint textVertexShader;
-GLuint textFragmentShader;
 GLuint textFpsProgram;
 
+#ifdef HAVE_GLES3
+// Shader: triangle, ES 3.0. The model matrix is a per-instance attribute and
+// the projection comes from the shared uniform block.
+
+const GLchar* triangle_es3_vshader_source =
+    "#version 300 es\n"
+
+    "layout(location = 0) in vec3 position;"
+    "layout(location = 1) in vec3 color;"
+    "layout(location = 2) in mat4 model;"
+
+    "layout(std140) uniform Projections {"
+    " mat4 triangleProjection;"
+    " mat4 textProjection;"
+    "};"
+
+    "out vec3 Color;"
+
+    "void main() {"
+    " Color = color;"
+    " gl_Position = triangleProjection * model * vec4(position, 1.0);"
+    "}";
+
+const GLchar* triangle_es3_fshader_source =
+    "#version 300 es\n"
+
+    "precision mediump float;"
+
+    "in vec3 Color;"
+    "out vec4 fragColor;"
+
+    "void main() {"
+    " fragColor = vec4(Color, 1.0);"
+    "}";
+
+// Shader: text & FPS, ES 3.0
+
+const GLchar* text_es3_vshader_source =
+    "#version 300 es\n"
+
+    "layout(location = 0) in vec2 position;"
+    "layout(location = 1) in vec2 texcoord;"
+
+    "uniform mat4 model;"
+
+    "layout(std140) uniform Projections {"
+    " mat4 triangleProjection;"
+    " mat4 textProjection;"
+    "};"
+
+    "out vec2 Texcoord;"
+
+    "void main() {"
+    " Texcoord = texcoord;"
+    " gl_Position = textProjection * model * vec4(position, 0.0, 1.0);"
+    "}";
+
+const GLchar* text_es3_fshader_source =
+    "#version 300 es\n"
+
+    "precision mediump float;"
+
+    "in vec2 Texcoord;"
+    "out vec4 fragColor;"
+
+    "uniform sampler2D tex;"
+    "void main() {"
+    " fragColor = texture(tex, Texcoord).bgra;"
+    "}";
+
+#define PROJECTIONS_BINDING                                            0
+#endif
+
+ProgramCache programCache;
+
+Instances instances;
+
+JobSystem jobSystem;
+
+Resolution resolution;
+char dynamicResolution = 0;
+
+AntiAlias antialias;
+
+GpuProfile gpuProfile;
+
+PerfCounters perfCounters;
+
+Metrics metrics;
+
+RealTime realtime;
+
+Jitter jitter;
+
 // Buffers
 
 GLuint triangleVbo;
 GLuint textVbo;
 GLuint fpsVbo;
 
+#ifdef HAVE_GLES3
+GLuint instanceVbo;
+GLuint projectionsUbo;
+
+GLuint triangleVao;
+GLuint textVao;
+GLuint fpsVao;
+#endif
+
 // Cairo resources, textures: text & FPS
 
 cairo_surface_t* textSurface;
 cairo_t* textCr;
-GLint textTexture;
+GLuint textTexture;
 
 cairo_surface_t* fpsSurface;
 cairo_t* fpsCr;
-GLint fpsTexture;
+GLuint fpsTexture;
 
 // Shaders
 
-void init_shaders() {
-    // Triangle
-
-    triangleVertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(triangleVertexShader, 1, &triangle_vshader_source, 0);
-    glCompileShader(triangleVertexShader);
+// Returns 0 if a program doesn't build, e.g. a shader the driver rejects.
+char init_shaders() {
+    program_cache_init(&programCache, NULL);
 
-    glCheck();
+#ifdef HAVE_GLES3
+    if (window->glesVersion >= 3) {
+        triangleProgram = gl_resources_track(GL_RESOURCE_PROGRAM, program_cache_build(&programCache, triangle_es3_vshader_source, triangle_es3_fshader_source, NULL), "triangle");
+        textFpsProgram = gl_resources_track(GL_RESOURCE_PROGRAM, program_cache_build(&programCache, text_es3_vshader_source, text_es3_fshader_source, NULL), "text");
 
-    triangleFragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(triangleFragmentShader, 1, &triangle_fshader_source, 0);
-    glCompileShader(triangleFragmentShader);
+        glUniformBlockBinding(triangleProgram, glGetUniformBlockIndex(triangleProgram, "Projections"), PROJECTIONS_BINDING);
+        glUniformBlockBinding(textFpsProgram, glGetUniformBlockIndex(textFpsProgram, "Projections"), PROJECTIONS_BINDING);
 
-    glCheck();
-
-    triangleProgram = glCreateProgram();
-    glAttachShader(triangleProgram, triangleVertexShader);
-    glAttachShader(triangleProgram, triangleFragmentShader);
-    glLinkProgram(triangleProgram);
-
-    glCheck();
-
-    // Text & FPS
-
-    textVertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(textVertexShader, 1, &text_vshader_source, 0);
-    glCompileShader(textVertexShader);
+        glCheck();
+    } else
+#endif
+    {
+        // Triangle
 
-    glCheck();
+        triangleProgram = gl_resources_track(GL_RESOURCE_PROGRAM, program_cache_build(&programCache, triangle_vshader_source, triangle_fshader_source, NULL), "triangle");
 
-    textFragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(textFragmentShader, 1, &text_fshader_source, 0);
-    glCompileShader(textFragmentShader);
+        glCheck();
 
-    glCheck();
+        // Text & FPS
 
-    textFpsProgram = glCreateProgram();
-    glAttachShader(textFpsProgram, textVertexShader);
-    glAttachShader(textFpsProgram, textFragmentShader);
-    glLinkProgram(textFpsProgram);
+        textFpsProgram = gl_resources_track(GL_RESOURCE_PROGRAM, program_cache_build(&programCache, text_vshader_source, text_fshader_source, NULL), "text");
 
-    glCheck();
+        glCheck();
+    }
 
     glUseProgram(textFpsProgram);
 
@@ -145,20 +290,25 @@ void init_shaders() {
     glUseProgram(0);
 
     glCheck();
+
+    program_cache_report(&programCache);
+
+    if (!triangleProgram || !textFpsProgram) {
+        fprintf(stderr, "Shaders: unable to build the OpenGL ES %d programs.\n", window->glesVersion);
+        return 0;
+    }
+
+    return 1;
 }
 
 void destroy_shaders() {
     // Triangle
 
-    glDeleteProgram(triangleProgram);
-    glDeleteShader(triangleFragmentShader);
-    glDeleteShader(triangleVertexShader);
+    gl_resources_delete(GL_RESOURCE_PROGRAM, &triangleProgram);
 
     // Text
 
-    glDeleteProgram(textFpsProgram);
-    glDeleteShader(textFragmentShader);
-    glDeleteShader(textVertexShader);
+    gl_resources_delete(GL_RESOURCE_PROGRAM, &textFpsProgram);
 }
 
 // Buffers
@@ -172,9 +322,10 @@ void init_buffers() {
          0.5f, -0.5f, 0.0f, 0.0f, 0.0f, 1.0f,    // right vertex, blue
     };
 
-    glGenBuffers(1, &triangleVbo);
+    gl_resources_gen(GL_RESOURCE_BUFFER, &triangleVbo, "triangle");
     glBindBuffer(GL_ARRAY_BUFFER, triangleVbo);
     glBufferData(GL_ARRAY_BUFFER, sizeof(triangle_vertices), triangle_vertices, GL_STATIC_DRAW);
+    gl_resources_storage(GL_RESOURCE_BUFFER, triangleVbo, sizeof(triangle_vertices));
 
     glCheck();
 
@@ -187,9 +338,10 @@ void init_buffers() {
           TEXT_WIDTH, 0.0f, 1.0f, 0.0f,        // lower right
     };
 
-    glGenBuffers(1, &textVbo);
+    gl_resources_gen(GL_RESOURCE_BUFFER, &textVbo, "text");
     glBindBuffer(GL_ARRAY_BUFFER, textVbo);
     glBufferData(GL_ARRAY_BUFFER, sizeof(text_vertices), text_vertices, GL_STATIC_DRAW);
+    gl_resources_storage(GL_RESOURCE_BUFFER, textVbo, sizeof(text_vertices));
 
     glCheck();
 
@@ -202,22 +354,108 @@ void init_buffers() {
           FPS_WIDTH, 0.0f, 1.0f, 0.0f,         // lower right
     };
 
-    glGenBuffers(1, &fpsVbo);
+    gl_resources_gen(GL_RESOURCE_BUFFER, &fpsVbo, "fps");
     glBindBuffer(GL_ARRAY_BUFFER, fpsVbo);
     glBufferData(GL_ARRAY_BUFFER, sizeof(fps_vertices), fps_vertices, GL_STATIC_DRAW);
+    gl_resources_storage(GL_RESOURCE_BUFFER, fpsVbo, sizeof(fps_vertices));
 
     glCheck();
+
+#ifdef HAVE_GLES3
+    if (window->glesVersion >= 3) {
+        // Instance transforms, respecified every frame
+
+        gl_resources_gen(GL_RESOURCE_BUFFER, &instanceVbo, "instances");
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+        glBufferData(GL_ARRAY_BUFFER, 16 * sizeof(GLfloat) * instances.count, NULL, GL_STREAM_DRAW);
+        gl_resources_storage(GL_RESOURCE_BUFFER, instanceVbo, 16 * sizeof(GLfloat) * instances.count);
+
+        // Projections, shared by both programs
+
+        gl_resources_gen(GL_RESOURCE_BUFFER, &projectionsUbo, "projections");
+        glBindBuffer(GL_UNIFORM_BUFFER, projectionsUbo);
+        glBufferData(GL_UNIFORM_BUFFER, 2 * 16 * sizeof(GLfloat), NULL, GL_STATIC_DRAW);
+        gl_resources_storage(GL_RESOURCE_BUFFER, projectionsUbo, 2 * 16 * sizeof(GLfloat));
+        glBindBufferBase(GL_UNIFORM_BUFFER, PROJECTIONS_BINDING, projectionsUbo);
+
+        glCheck();
+    }
+#endif
 }
 
 void destroy_buffers() {
-    glDeleteBuffers(1, &fpsVbo);
-    glDeleteBuffers(1, &textVbo);
-    glDeleteBuffers(1, &triangleVbo);
+#ifdef HAVE_GLES3
+    if (window->glesVersion >= 3) {
+        gl_resources_delete(GL_RESOURCE_BUFFER, &projectionsUbo);
+        gl_resources_delete(GL_RESOURCE_BUFFER, &instanceVbo);
+    }
+#endif
+    gl_resources_delete(GL_RESOURCE_BUFFER, &fpsVbo);
+    gl_resources_delete(GL_RESOURCE_BUFFER, &textVbo);
+    gl_resources_delete(GL_RESOURCE_BUFFER, &triangleVbo);
 }
 
+#ifdef HAVE_GLES3
+// Vertex arrays: the attribute layout is specified once here rather than on
+// every draw.
+
+void init_vertex_arrays() {
+    // Triangle
+
+    gl_resources_gen(GL_RESOURCE_VERTEX_ARRAY, &triangleVao, "triangle");
+    glBindVertexArray(triangleVao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, triangleVbo);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, 0, 6*sizeof(GLfloat), (const GLvoid*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, 0, 6*sizeof(GLfloat), (const GLvoid*)(3*sizeof(GLfloat)));
+
+    // A mat4 attribute takes four consecutive locations, one per column.
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+    for (GLuint column = 0; column < 4; column++) {
+        glEnableVertexAttribArray(2 + column);
+        glVertexAttribPointer(2 + column, 4, GL_FLOAT, 0, 16*sizeof(GLfloat), (const GLvoid*)(column*4*sizeof(GLfloat)));
+        glVertexAttribDivisor(2 + column, 1);
+    }
+
+    glCheck();
+
+    // Text & FPS
+
+    GLuint quadVbos[] = { textVbo, fpsVbo };
+    GLuint* quadVaos[] = { &textVao, &fpsVao };
+    const char* quadLabels[] = { "text", "fps" };
+
+    for (unsigned i = 0; i < 2; i++) {
+        gl_resources_gen(GL_RESOURCE_VERTEX_ARRAY, quadVaos[i], quadLabels[i]);
+        glBindVertexArray(*quadVaos[i]);
+
+        glBindBuffer(GL_ARRAY_BUFFER, quadVbos[i]);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 2, GL_FLOAT, 0, 4*sizeof(GLfloat), (const GLvoid*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, 0, 4*sizeof(GLfloat), (const GLvoid*)(2*sizeof(GLfloat)));
+    }
+
+    glBindVertexArray(0);
+
+    glCheck();
+}
+
+void destroy_vertex_arrays() {
+    gl_resources_delete(GL_RESOURCE_VERTEX_ARRAY, &fpsVao);
+    gl_resources_delete(GL_RESOURCE_VERTEX_ARRAY, &textVao);
+    gl_resources_delete(GL_RESOURCE_VERTEX_ARRAY, &triangleVao);
+}
+#endif
+
 // Textures
 
-void init_textures() {
+void* rasterize_text(void* arg) {
+    trace_thread_name("rasterize");
+    TRACE_SCOPE("rasterize_text");
+
     // Text
 
     textSurface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, TEXT_WIDTH, TEXT_HEIGHT);
@@ -233,29 +471,44 @@ void init_textures() {
     cairo_move_to(textCr, 0, 30);
     cairo_show_text(textCr, "Click to animate.");
 
+    // FPS
+
+    fpsSurface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, FPS_WIDTH, FPS_HEIGHT);
+    fpsCr = cairo_create(fpsSurface);
+
+    startup_mark("rasterize_text (worker)");
+
+    return NULL;
+}
+
+void init_textures() {
+    // Text
+
     unsigned char* pixels = cairo_image_surface_get_data(textSurface);
 
-    glGenTextures(1, &textTexture);
+    gl_resources_gen(GL_RESOURCE_TEXTURE, &textTexture, "text");
     glBindTexture(GL_TEXTURE_2D, textTexture);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, TEXT_WIDTH, TEXT_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    gl_resources_storage(GL_RESOURCE_TEXTURE, textTexture, TEXT_WIDTH * TEXT_HEIGHT * 4);
 
     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, (GLfloat)GL_NEAREST);
     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, (GLfloat)GL_NEAREST);
 
     // FPS
 
-    fpsSurface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, FPS_WIDTH, FPS_HEIGHT);
-    fpsCr = cairo_create(fpsSurface);
-
-    glGenTextures(1, &fpsTexture);
+    // Its storage is respecified with every update, always at this size.
+    gl_resources_gen(GL_RESOURCE_TEXTURE, &fpsTexture, "fps");
+    gl_resources_storage(GL_RESOURCE_TEXTURE, fpsTexture, FPS_WIDTH * FPS_HEIGHT * 4);
     glBindTexture(GL_TEXTURE_2D, fpsTexture);
     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, (GLfloat)GL_NEAREST);
     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, (GLfloat)GL_NEAREST);
 }
 
 void update_fps_texture(float fps) {
-    char fpsStr[10];
-    sprintf(fpsStr, "%.2f FPS", fps);
+    TRACE_SCOPE("update_fps_texture");
+
+    char fpsStr[16];
+    snprintf(fpsStr, sizeof(fpsStr), "%.2f FPS", fps);
 
     cairo_set_source_rgba(fpsCr, 0, 0, 0, 0);
     cairo_set_operator(fpsCr, CAIRO_OPERATOR_SOURCE);
@@ -279,34 +532,53 @@ void update_fps_texture(float fps) {
 void destroy_textures() {
     // Text
 
-    glDeleteTextures(1, &textTexture);
+    gl_resources_delete(GL_RESOURCE_TEXTURE, &textTexture);
     cairo_destroy(textCr);
     cairo_surface_destroy(textSurface);
 
     // FPS
 
-    glDeleteTextures(1, &fpsTexture);
+    gl_resources_delete(GL_RESOURCE_TEXTURE, &fpsTexture);
     cairo_destroy(fpsCr);
     cairo_surface_destroy(fpsSurface);
 }
 
 // Matrix uniforms
 
+typedef struct {
+    Instances* instances;
+    const GLfloat* model;
+} InstancesJob;
+
+void update_instances_job(void* data, unsigned begin, unsigned end) {
+    InstancesJob* job = data;
+    instances_update_range(job->instances, job->model, begin, end);
+}
+
 void update_triangle_model() {
-    glUseProgram(triangleProgram);
+    TRACE_SCOPE("update_triangle_model");
 
-    GLint modelUniform = glGetUniformLocation(triangleProgram, "model");
-    GLfloat* triangleModelMatrix = mat4_identity(NULL);
+    GLfloat triangleModelMatrix[16];
+    mat4_identity(triangleModelMatrix);
 
-    mat4_rotate(triangleModelMatrix, triangleModelMatrix, rotation[0], X);
-    mat4_rotate(triangleModelMatrix, triangleModelMatrix, rotation[1], Y);
-    mat4_rotate(triangleModelMatrix, triangleModelMatrix, rotation[2], Z);
+    mat4_rotate(triangleModelMatrix, triangleModelMatrix, drawnRotation[0], X);
+    mat4_rotate(triangleModelMatrix, triangleModelMatrix, drawnRotation[1], Y);
+    mat4_rotate(triangleModelMatrix, triangleModelMatrix, drawnRotation[2], Z);
 
-    glUniformMatrix4fv(modelUniform, 1, GL_FALSE, triangleModelMatrix);
+    // Split across the job system's workers, if --jobs started any.
+    InstancesJob job = { &instances, triangleModelMatrix };
+    jobs_parallel_for(&jobSystem, instances.count, INSTANCES_GRAIN, update_instances_job, &job);
 
-    free(triangleModelMatrix);
+#ifdef HAVE_GLES3
+    if (window->glesVersion >= 3) {
+        // Respecifying the whole store lets the driver orphan the previous
+        // frame's copy instead of waiting for it.
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+        glBufferData(GL_ARRAY_BUFFER, 16 * sizeof(GLfloat) * instances.count, instances.transforms, GL_STREAM_DRAW);
 
-    glCheck();
+        glCheck();
+    }
+#endif
 }
 
 void update_text_model() {
@@ -315,12 +587,11 @@ void update_text_model() {
     GLint modelUniform = glGetUniformLocation(textFpsProgram, "model");
 
     GLfloat translation[] = { 16, 16, 0 };
-    GLfloat* textModelMatrix = mat4_translate(NULL, NULL, translation);
+    GLfloat textModelMatrix[16];
+    mat4_translate(textModelMatrix, NULL, translation);
 
     glUniformMatrix4fv(modelUniform, 1, GL_FALSE, textModelMatrix);
 
-    free(textModelMatrix);
-
     glCheck();
 }
 
@@ -330,31 +601,49 @@ void update_fps_model() {
     GLint modelUniform = glGetUniformLocation(textFpsProgram, "model");
 
     GLfloat translation[] = { 16, window->height - 32, 0 };
-    GLfloat* fpsModelMatrix = mat4_translate(NULL, NULL, translation);
+    GLfloat fpsModelMatrix[16];
+    mat4_translate(fpsModelMatrix, NULL, translation);
 
     glUniformMatrix4fv(modelUniform, 1, GL_FALSE, fpsModelMatrix);
 
-    free(fpsModelMatrix);
-
     glCheck();
 }
 
 void update_projection() {
+#ifdef HAVE_GLES3
+    if (window->glesVersion >= 3) {
+        GLfloat projectionMatrix[16];
+        mat4_identity(projectionMatrix);
+
+        float aspect = (float)window->width / window->height;
+        projectionMatrix[5] = aspect;
+
+        GLfloat textProjectionMatrix[16];
+        mat4_orthographic(textProjectionMatrix, 0, window->width, 0, window->height);
+
+        glBindBuffer(GL_UNIFORM_BUFFER, projectionsUbo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, 16 * sizeof(GLfloat), projectionMatrix);
+        glBufferSubData(GL_UNIFORM_BUFFER, 16 * sizeof(GLfloat), 16 * sizeof(GLfloat), textProjectionMatrix);
+
+        glCheck();
+
+        return;
+    }
+#endif
     {
         // Triangle
 
         glUseProgram(triangleProgram);
 
         GLint projectionUniform = glGetUniformLocation(triangleProgram, "projection");
-        GLfloat* projectionMatrix = mat4_identity(NULL);
+        GLfloat projectionMatrix[16];
+        mat4_identity(projectionMatrix);
 
         float aspect = (float)window->width / window->height;
         projectionMatrix[5] = aspect;
 
         glUniformMatrix4fv(projectionUniform, 1, GL_FALSE, projectionMatrix);
 
-        free(projectionMatrix);
-
         glCheck();
     }
     {
@@ -363,47 +652,58 @@ void update_projection() {
         glUseProgram(textFpsProgram);
 
         GLint projectionUniform = glGetUniformLocation(textFpsProgram, "projection");
-        GLfloat* projectionMatrix = mat4_orthographic(NULL, 0, window->width, 0, window->height);
+        GLfloat projectionMatrix[16];
+        mat4_orthographic(projectionMatrix, 0, window->width, 0, window->height);
 
         glUniformMatrix4fv(projectionUniform, 1, GL_FALSE, projectionMatrix);
 
-        free(projectionMatrix);
-
         glCheck();
     }
 }
 
 // Draw
 
-void draw() {
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+void draw_triangle_es2() {
+    TRACE_SCOPE("draw_triangle");
+    gpu_profile_begin(&gpuProfile, "triangle");
 
-    {
-        // Triangle
+    // Triangle: one draw call per instance
 
-        glUseProgram(triangleProgram);
+    glUseProgram(triangleProgram);
 
-        update_triangle_model();
+    update_triangle_model();
 
-        glBindBuffer(GL_ARRAY_BUFFER, triangleVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, triangleVbo);
 
-        GLint positionAttribute = glGetAttribLocation(triangleProgram, "position");
-        GLint colorAttribute = glGetAttribLocation(triangleProgram, "color");
+    GLint positionAttribute = glGetAttribLocation(triangleProgram, "position");
+    GLint colorAttribute = glGetAttribLocation(triangleProgram, "color");
 
-        glEnableVertexAttribArray(positionAttribute);
-        glVertexAttribPointer(positionAttribute, 3, GL_FLOAT, 0, 6*sizeof(GLfloat), (const GLvoid*)0);
-        glEnableVertexAttribArray(colorAttribute);
-        glVertexAttribPointer(colorAttribute, 3, GL_FLOAT, 0, 6*sizeof(GLfloat), (const GLvoid*)(3*sizeof(GLfloat)));
-        
-        glCheck();
+    glEnableVertexAttribArray(positionAttribute);
+    glVertexAttribPointer(positionAttribute, 3, GL_FLOAT, 0, 6*sizeof(GLfloat), (const GLvoid*)0);
+    glEnableVertexAttribArray(colorAttribute);
+    glVertexAttribPointer(colorAttribute, 3, GL_FLOAT, 0, 6*sizeof(GLfloat), (const GLvoid*)(3*sizeof(GLfloat)));
+    
+    glCheck();
 
-        glDrawArrays(GL_TRIANGLES, 0, 3);
+    GLint modelUniform = glGetUniformLocation(triangleProgram, "model");
 
-        glCheck();
+    for (unsigned k = 0; k < instances.count; k++) {
+        glUniformMatrix4fv(modelUniform, 1, GL_FALSE, &instances.transforms[16 * k]);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
     }
+
+    glCheck();
+
+    gpu_profile_end(&gpuProfile);
+}
+
+void draw_hud_es2() {
     {
         // Text
 
+        TRACE_SCOPE("draw_text");
+        gpu_profile_begin(&gpuProfile, "text");
+
         glUseProgram(textFpsProgram);
 
         update_text_model();
@@ -426,10 +726,15 @@ void draw() {
         glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
         glCheck();
+
+        gpu_profile_end(&gpuProfile);
     }
     {
         // FPS
 
+        TRACE_SCOPE("draw_fps");
+        gpu_profile_begin(&gpuProfile, "fps");
+
         glUseProgram(textFpsProgram);
 
         update_fps_model();
@@ -451,89 +756,221 @@ void draw() {
         glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
         glCheck();
+
+        gpu_profile_end(&gpuProfile);
+    }
+}
+
+#ifdef HAVE_GLES3
+void draw_triangle_es3() {
+    TRACE_SCOPE("draw_triangle");
+    gpu_profile_begin(&gpuProfile, "triangle");
+
+    // Triangle: every instance in one draw call
+
+    glUseProgram(triangleProgram);
+
+    update_triangle_model();
+
+    glBindVertexArray(triangleVao);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 3, instances.count);
+
+    glCheck();
+
+    glBindVertexArray(0);
+
+    gpu_profile_end(&gpuProfile);
+}
+
+void draw_hud_es3() {
+    {
+        // Text
+
+        TRACE_SCOPE("draw_text");
+        gpu_profile_begin(&gpuProfile, "text");
+
+        glUseProgram(textFpsProgram);
+
+        update_text_model();
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, textTexture);
+
+        glBindVertexArray(textVao);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+        glCheck();
+
+        gpu_profile_end(&gpuProfile);
+    }
+    {
+        // FPS
+
+        TRACE_SCOPE("draw_fps");
+        gpu_profile_begin(&gpuProfile, "fps");
+
+        glUseProgram(textFpsProgram);
+
+        update_fps_model();
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, fpsTexture);
+
+        glBindVertexArray(fpsVao);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+        glCheck();
+
+        gpu_profile_end(&gpuProfile);
+    }
+
+    glBindVertexArray(0);
+}
+#endif
+
+void draw() {
+    TRACE_SCOPE("draw");
+
+    // With dynamic resolution the scene goes to the scaled offscreen target
+    // and is upscaled to the display; with FXAA it goes to a native-size one
+    // and is filtered onto the display. The HUD is always drawn at native
+    // resolution on top, without anti-aliasing.
+
+    if (dynamicResolution) {
+        resolution_begin(&resolution);
+    } else {
+        antialias_begin(&antialias);
+    }
+
+#ifdef HAVE_GLES3
+    if (window->glesVersion >= 3) {
+        draw_triangle_es3();
+    } else
+#endif
+    draw_triangle_es2();
+
+    {
+        TRACE_SCOPE("post_process");
+
+        if (dynamicResolution) {
+            gpu_profile_begin(&gpuProfile, "upscale");
+            resolution_end(&resolution);
+            gpu_profile_end(&gpuProfile);
+        } else if (antialias.mode == ANTIALIAS_FXAA) {
+            gpu_profile_begin(&gpuProfile, "fxaa");
+            antialias_end(&antialias);
+            gpu_profile_end(&gpuProfile);
+        } else {
+            antialias_end(&antialias);
+        }
     }
+
+#ifdef HAVE_GLES3
+    if (window->glesVersion >= 3) {
+        draw_hud_es3();
+    } else
+#endif
+    draw_hud_es2();
 }
 
 void swap_buffers() {
+    TRACE_SCOPE("swap_buffers");
+
     glFlush();
     glFinish();
+    gl_debug_frame();
     
     glCheck();
 
-    eglSwapBuffers(window->display, window->surface);
+    window_swap(window);
 
     glCheck();
 }
 
-char animation_frame() {
+char animation_step() {
+    TRACE_SCOPE("animation_step");
+
+    const GLfloat radians = DEGREES_TO_RADIANS(ANIMATION_DEGREES_PER_SECOND * simClock.step);
     char modified = 0;
 
+    memcpy(previousRotation, rotation, sizeof(rotation));
+
     if (rotation[0] < 2 * M_PI) {
-        rotation[0] += DEGREES_TO_RADIANS(1);
+        rotation[0] += radians;
         modified = 1;
     }
     if (rotation[1] < 2 * M_PI) {
-        rotation[1] += DEGREES_TO_RADIANS(1);
+        rotation[1] += radians;
         modified = 1;
     }
     if (rotation[2] < 2 * M_PI) {
-        rotation[2] += DEGREES_TO_RADIANS(1);
+        rotation[2] += radians;
         modified = 1;
     }
 
     return modified;
 }
 
-// Main
-
-int main(int argc, char** argv) {
-    // Initialize keyboard, mouse and window
-
-    Keyboard* keyboard = keyboard_init(NULL, "/dev/input/event1");
-    Mouse* mouse = mouse_init(NULL, "/dev/input/event0");
-    window = window_init(NULL);
-
-    // Setup
+void animation_interpolate(const Scene* scene, float alpha) {
+    for (int i = 0; i < 3; i++) {
+        drawnRotation[i] = scene->previousRotation[i] + (scene->rotation[i] - scene->previousRotation[i]) * alpha;
+    }
+}
 
-    init_shaders();
-    init_buffers();
-    init_textures();
+// Simulation thread
 
-    update_projection();
+void* simulate(void* arg) {
+    trace_thread_name("simulation");
+    realtime_thread(&realtime, "simulation", realtime.simulationCpu, REALTIME_SIMULATION_PRIORITY);
 
-    int mouseY;
+    int mouseY = 0;
     char mousePressed[] = { 0, 0 };
-    
-    char animate = 0;
-    struct timeval frameTime[2];
-    struct timeval fpsUpdateTime;
 
-    gettimeofday(&frameTime[1], NULL);
-    gettimeofday(&fpsUpdateTime, NULL);
+    char animate = !mouse;
+    char firstTick = 1;
+    uint32_t sequence = 0;
+    uint64_t tickMicros[2] = { 0, 0 };
+    struct timespec nextTick;
 
-    update_fps_texture(0);
+    clock_gettime(CLOCK_MONOTONIC, &nextTick);
 
-    // Loop
+    while (!__atomic_load_n(&quit, __ATOMIC_ACQUIRE)) {
+        TRACE_SCOPE("tick");
 
-    while (1) {
-        if (keyboard_key_is_pressed(keyboard, KEY_ESC)) {
+        // Paces a replay and hands over the input recorded for this tick.
+        if (!input_log_frame(&tickMicros[0])) {
+            break;
+        }
+        double tickSeconds = firstTick ? 0 : (tickMicros[0] - tickMicros[1]) / 1e6;
+        tickMicros[1] = tickMicros[0];
+        firstTick = 0;
+
+        if (keyboard && keyboard_key_is_pressed(keyboard, KEY_ESC)) {
             break;
         }
 
         // Check for mouse click: toggle animation
 
         mousePressed[1] = mousePressed[0];
-        mousePressed[0] = mouse_state(mouse, NULL, &mouseY) & BUTTON_LEFT;
+        mousePressed[0] = mouse ? mouse_state(mouse, NULL, &mouseY) & BUTTON_LEFT : 0;
 
         if (!mousePressed[0] && mousePressed[1]) {
             animate = !animate;
+            sim_clock_reset(&simClock);
         }
 
         if (animate) {
-            // Animating
-
-            if (!animation_frame()) {
-                animate = 0;
+            // Animating, in as many fixed steps as the tick took
+
+            unsigned steps = sim_clock_advance(&simClock, tickSeconds);
+            for (unsigned i = 0; i < steps && animate; i++) {
+                if (!animation_step()) {
+                    animate = !mouse;
+                    if (animate) {
+                        memset(rotation, 0, sizeof(rotation));
+                        memset(previousRotation, 0, sizeof(previousRotation));
+                    }
+                }
             }
         } else {
             // Controlling with the mouse
@@ -542,17 +979,406 @@ int main(int argc, char** argv) {
             float radians = 2 * M_PI * mouseYndc;
 
             memset(rotation, 0, sizeof(rotation));
-            if (keyboard_key_is_pressed(keyboard, KEY_X)) {
+            if (keyboard && keyboard_key_is_pressed(keyboard, KEY_X)) {
                 rotation[0] = radians;
             }
-            if (keyboard_key_is_pressed(keyboard, KEY_Y)) {
+            if (keyboard && keyboard_key_is_pressed(keyboard, KEY_Y)) {
                 rotation[1] = radians;
             }
-            if (keyboard_key_is_pressed(keyboard, KEY_Z)) {
+            if (keyboard && keyboard_key_is_pressed(keyboard, KEY_Z)) {
                 rotation[2] = radians;
             }
+            memcpy(previousRotation, rotation, sizeof(rotation));
+        }
+
+        // Publish the tick
+
+        Scene* scene = scene_buffer_back(&sceneBuffer);
+        scene->sequence = ++sequence;
+        memcpy(scene->rotation, rotation, sizeof(rotation));
+        memcpy(scene->previousRotation, previousRotation, sizeof(previousRotation));
+        scene->alpha = sim_clock_alpha(&simClock);
+        clock_gettime(CLOCK_MONOTONIC, &scene->time);
+        if (mouse) {
+            scene->mouseEvent = mouse->lastEvent;
+        }
+        if (keyboard) {
+            scene->keyboardEvent = keyboard->lastEvent;
+        }
+        scene_buffer_publish(&sceneBuffer);
+
+        if (lockstep) {
+            lockstep_signal();
+
+            pthread_mutex_lock(&lockstepMutex);
+            while (__atomic_load_n(&drawnSequence, __ATOMIC_ACQUIRE) < sequence && !__atomic_load_n(&quit, __ATOMIC_ACQUIRE)) {
+                pthread_cond_wait(&lockstepCondition, &lockstepMutex);
+            }
+            pthread_mutex_unlock(&lockstepMutex);
+        } else {
+            // Ticks missed while the thread was held up aren't made up;
+            // the clock has already accounted for the time.
+            nextTick.tv_nsec += simClock.step * 1e9;
+            if (nextTick.tv_nsec >= 1000000000) {
+                nextTick.tv_sec++;
+                nextTick.tv_nsec -= 1000000000;
+            }
+
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            if (now.tv_sec > nextTick.tv_sec || (now.tv_sec == nextTick.tv_sec && now.tv_nsec > nextTick.tv_nsec)) {
+                nextTick = now;
+            }
+
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &nextTick, NULL) == EINTR);
+        }
+    }
+
+    __atomic_store_n(&quit, 1, __ATOMIC_RELEASE);
+    lockstep_signal();
+
+    return NULL;
+}
+
+// Metrics
+
+void record_input_latency(const struct timeval* event, struct timeval* consumed, const struct timespec* presented) {
+    // Only the newest event per device is timed, once, against the first
+    // swap after it was read.
+    if (!timercmp(event, consumed, >)) {
+        return;
+    }
+    *consumed = *event;
+
+    float latencyMillis = (presented->tv_sec - event->tv_sec) * 1000.0f + (presented->tv_nsec / 1000 - event->tv_usec) / 1000.0f;
+    metrics_input(&metrics, latencyMillis);
+}
+
+// Jobs benchmark
+
+// Times the instance transforms of a large grid with 1 worker, then 2, and
+// so on up to one per CPU, to show how the job system scales here.
+int benchmark_jobs(unsigned count) {
+    Instances grid;
+    instances_init(&grid, count);
+
+    GLfloat model[16];
+    mat4_identity(model);
+    mat4_rotate(model, model, DEGREES_TO_RADIANS(30), X);
+    InstancesJob job = { &grid, model };
+
+    unsigned cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus > JOBS_MAX_WORKERS) {
+        cpus = JOBS_MAX_WORKERS;
+    }
+
+    printf("Jobs: %u instances, %u iterations per run\n", grid.count, JOBS_BENCHMARK_ITERATIONS);
+    printf("Jobs: workers  ms/iteration  speedup  efficiency\n");
+
+    double baselineMillis = 0;
+    for (unsigned workers = 1; workers <= cpus; workers++) {
+        jobs_init(&jobSystem, workers, NULL);
+
+        // Warm up: threads started, caches and TLB filled.
+        for (unsigned i = 0; i < 10; i++) {
+            jobs_parallel_for(&jobSystem, grid.count, INSTANCES_GRAIN, update_instances_job, &job);
+        }
+
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (unsigned i = 0; i < JOBS_BENCHMARK_ITERATIONS; i++) {
+            jobs_parallel_for(&jobSystem, grid.count, INSTANCES_GRAIN, update_instances_job, &job);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        jobs_destroy(&jobSystem);
+
+        double millis = ((end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6) / JOBS_BENCHMARK_ITERATIONS;
+        if (workers == 1) {
+            baselineMillis = millis;
+        }
+        printf("Jobs: %7u  %12.3f  %6.2fx  %9.0f%%\n", workers, millis, baselineMillis / millis, 100 * baselineMillis / millis / workers);
+    }
+
+    instances_destroy(&grid);
+
+    return 0;
+}
+
+// Main
+
+int main(int argc, char** argv) {
+    startup_begin();
+
+    // Options: --instances N draws N triangles in a grid, --gles2 skips the
+    // ES 3.0 path for comparison, --window picks the platform backend and
+    // --frames N quits after N frames and reports the frame rate. --budget MS
+    // scales the scene's resolution to keep frames within MS milliseconds.
+    // --aa off|msaa2|msaa4|fxaa picks the anti-aliasing. --perf reads the
+    // CPU's performance counters around each stage of the frame loop.
+    // --assert-no-alloc fails the run if the frame loop allocates after
+    // warming up. --metrics [NAME] publishes frame and input metrics to
+    // shared memory for hello-triangle-metrics to read. --gl-debug
+    // off|async|strict picks how GL errors are caught. --record FILE saves
+    // the input read in each tick; --replay FILE plays it back instead of
+    // the input devices, at --replay-speed times the recorded pace (0 for
+    // as fast as possible), and quits after the recorded ticks. --realtime
+    // [RENDER,SIMULATION] pins the two threads to those CPUs under a
+    // real-time policy and locks memory. --jobs N computes the instance
+    // transforms on N workers (0 for one per CPU); --jobs-benchmark times
+    // them with 1 worker up to one per CPU and quits.
+
+    trace_init("hello-triangle.trace.json");
+
+    unsigned instanceCount = 1;
+    int maxGlesVersion = 3;
+    const char* backendName = NULL;
+    unsigned frameLimit = 0;
+    float budgetMillis = 0;
+    AntiAliasMode antialiasMode = ANTIALIAS_OFF;
+    char perf = 0;
+    char assertNoAlloc = 0;
+    const char* metricsName = NULL;
+    const char* recordPath = NULL;
+    const char* replayPath = NULL;
+    float replaySpeed = 1;
+    char realtimeMode = 0;
+    int renderCpu = -1;
+    int simulationCpu = -1;
+    int jobWorkers = -1;
+    char jobsBenchmark = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--instances") && i + 1 < argc) {
+            instanceCount = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--gles2")) {
+            maxGlesVersion = 2;
+        } else if (!strcmp(argv[i], "--window") && i + 1 < argc) {
+            backendName = argv[++i];
+        } else if (!strcmp(argv[i], "--frames") && i + 1 < argc) {
+            frameLimit = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--budget") && i + 1 < argc) {
+            budgetMillis = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--aa") && i + 1 < argc) {
+            if (!antialias_parse(argv[++i], &antialiasMode)) {
+                return 1;
+            }
+        } else if (!strcmp(argv[i], "--perf")) {
+            perf = 1;
+        } else if (!strcmp(argv[i], "--assert-no-alloc")) {
+#ifdef HAVE_ALLOC_TRACK
+            assertNoAlloc = 1;
+#else
+            fprintf(stderr, "AllocTrack: --assert-no-alloc needs a build with make ALLOC_TRACK=1\n");
+            return 1;
+#endif
+        } else if (!strcmp(argv[i], "--gl-debug") && i + 1 < argc) {
+            GlDebugMode glDebugMode;
+            if (!gl_debug_parse(argv[++i], &glDebugMode)) {
+                return 1;
+            }
+            gl_debug_set_mode(glDebugMode);
+        } else if (!strcmp(argv[i], "--metrics")) {
+            metricsName = i + 1 < argc && argv[i + 1][0] == '/' ? argv[++i] : METRICS_DEFAULT_NAME;
+        } else if (!strcmp(argv[i], "--record") && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (!strcmp(argv[i], "--replay") && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (!strcmp(argv[i], "--replay-speed") && i + 1 < argc) {
+            replaySpeed = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--jobs") && i + 1 < argc) {
+            jobWorkers = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--jobs-benchmark")) {
+            jobsBenchmark = 1;
+        } else if (!strcmp(argv[i], "--realtime")) {
+            realtimeMode = 1;
+            if (i + 1 < argc && argv[i + 1][0] >= '0' && argv[i + 1][0] <= '9' && !realtime_parse(argv[++i], &renderCpu, &simulationCpu)) {
+                return 1;
+            }
+        }
+    }
+
+    if (recordPath && replayPath) {
+        fprintf(stderr, "InputLog: --record and --replay can't be used together.\n");
+        return 1;
+    }
+
+    if (jobsBenchmark) {
+        return benchmark_jobs(instanceCount > 1 ? instanceCount : JOBS_BENCHMARK_INSTANCES);
+    }
+
+    const WindowBackend* backend = window_backend(backendName);
+    if (!backend) {
+        return 1;
+    }
+
+    instances_init(&instances, instanceCount);
+
+    // Rasterize the help text while the window and context come up; Cairo
+    // doesn't need the GL context.
+
+    pthread_t rasterizeThread;
+    pthread_create(&rasterizeThread, NULL, rasterize_text, NULL);
+
+    // Initialize keyboard, mouse and window. Either input device may be
+    // missing, e.g. headless or over SSH; the scene then animates on its own.
+    // A replay stands in for both, with the devices of the recording.
+
+    if (replayPath && !input_log_replay(replayPath, replaySpeed)) {
+        return 1;
+    }
+
+    const char* keyboardPath = input_log_device(INPUT_LOG_KEYBOARD, "/dev/input/event1");
+    const char* mousePath = input_log_device(INPUT_LOG_MOUSE, "/dev/input/event0");
+    keyboard = keyboardPath ? keyboard_init(NULL, keyboardPath) : NULL;
+    mouse = mousePath ? mouse_init(NULL, mousePath) : NULL;
+
+    if (recordPath && !input_log_record(recordPath, keyboard != NULL, mouse != NULL)) {
+        return 1;
+    }
+    startup_mark("input_init");
+
+    window = window_init(NULL, backend, maxGlesVersion, antialias_samples(antialiasMode));
+    if (!window) {
+        return 1;
+    }
+    startup_mark("window_init");
+
+    gl_debug_init();
+
+    // Setup
+
+    if (!init_shaders()) {
+        window_destroy(window);
+        return 1;
+    }
+    startup_mark("init_shaders");
+
+    init_buffers();
+#ifdef HAVE_GLES3
+    if (window->glesVersion >= 3) {
+        init_vertex_arrays();
+    }
+#endif
+    startup_mark("init_buffers");
+
+    pthread_join(rasterizeThread, NULL);
+    init_textures();
+    startup_mark("init_textures");
+
+    if (budgetMillis > 0) {
+        resolution_init(&resolution, window, &programCache, budgetMillis);
+        dynamicResolution = 1;
+
+        // The upscale pass would have to filter as well; not worth it on
+        // hardware that is already short of fill rate.
+        if (antialiasMode == ANTIALIAS_FXAA) {
+            fprintf(stderr, "AA: FXAA is not applied with dynamic resolution.\n");
+            antialiasMode = ANTIALIAS_OFF;
+        }
+    }
+
+    antialias_init(&antialias, window, &programCache, antialiasMode);
+
+    gpu_profile_init(&gpuProfile);
+
+    if (perf) {
+        perf_counters_init(&perfCounters);
+    }
+
+    if (metricsName) {
+        metrics_init(&metrics, metricsName);
+        metrics_set_refresh(&metrics, window->refreshHz);
+    }
+
+    gl_resources_label();
+    gl_resources_report();
+
+    update_projection();
+
+    sim_clock_init(&simClock, SIM_CLOCK_STEP_SECONDS, SIM_CLOCK_MAX_STEPS);
+    scene_buffer_init(&sceneBuffer);
+    lockstep = replayPath != NULL;
+
+    jitter_init(&jitter);
+
+    if (realtimeMode) {
+        realtime_init(&realtime, renderCpu, simulationCpu);
+    }
+
+    if (jobWorkers >= 0) {
+        jobs_init(&jobSystem, jobWorkers, &realtime);
+        printf("Jobs: %u workers\n", jobSystem.workerCount);
+    }
+
+    // Everything the loop needs exists by now; lock it in before the
+    // threads go real-time.
+    realtime_lock_memory(&realtime);
+
+    pthread_t simulationThread;
+    pthread_create(&simulationThread, NULL, simulate, NULL);
+
+    realtime_thread(&realtime, "render", realtime.renderCpu, REALTIME_RENDER_PRIORITY);
+
+    char firstFrame = 1;
+    unsigned frames = 0;
+    struct timeval startTime;
+    struct timeval frameTime[2];
+    struct timeval fpsUpdateTime;
+    struct timespec swapTime[2];
+    struct timeval mouseConsumed = { 0, 0 };
+    struct timeval keyboardConsumed = { 0, 0 };
+
+    gettimeofday(&frameTime[1], NULL);
+    gettimeofday(&fpsUpdateTime, NULL);
+
+    update_fps_texture(0);
+
+    // Loop
+
+    while (1) {
+        TRACE_SCOPE("frame");
+
+        trace_poll();
+
+        perf_counters_begin(&perfCounters);
+        alloc_track_begin();
+
+        // Take the newest scene the simulation has published; in lockstep,
+        // wait for the next one.
+        char fresh = scene_buffer_update(&sceneBuffer);
+        if (lockstep && !fresh) {
+            pthread_mutex_lock(&lockstepMutex);
+            while (!(fresh = scene_buffer_update(&sceneBuffer)) && !__atomic_load_n(&quit, __ATOMIC_ACQUIRE)) {
+                pthread_cond_wait(&lockstepCondition, &lockstepMutex);
+            }
+            pthread_mutex_unlock(&lockstepMutex);
         }
 
+        if (__atomic_load_n(&quit, __ATOMIC_ACQUIRE) && !(lockstep && fresh)) {
+            break;
+        }
+        if (frameLimit && frames == frameLimit) {
+            break;
+        }
+
+        // The clock has run on since the scene was published; blend as far
+        // as it has got. A lockstep frame shows its tick as it was.
+        const Scene* scene = scene_buffer_front(&sceneBuffer);
+        float alpha = scene->alpha;
+        if (!lockstep) {
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            alpha += ((now.tv_sec - scene->time.tv_sec) + (now.tv_nsec - scene->time.tv_nsec) / 1e9) / simClock.step;
+            if (alpha > 1) {
+                alpha = 1;
+            }
+        }
+        animation_interpolate(scene, alpha);
+
+        perf_counters_stage(&perfCounters, "scene");
+        alloc_track_stage("scene");
+
         // Update FPS display every 0.1 s
         
         gettimeofday(&frameTime[0], NULL);
@@ -573,21 +1399,142 @@ int main(int argc, char** argv) {
 
         frameTime[1] = frameTime[0];
 
+        perf_counters_stage(&perfCounters, "fps_texture");
+        alloc_track_stage("fps_texture");
+
         // Draw
 
+        struct timeval renderStart, renderEnd;
+        gettimeofday(&renderStart, NULL);
+
         draw();
+        gpu_profile_frame(&gpuProfile);
+
+        perf_counters_stage(&perfCounters, "draw");
+        alloc_track_stage("draw");
+
+        // Only the resolution controller needs the rendering timed alone,
+        // which drains the pipeline a second time per frame; otherwise the
+        // GPU profile times the passes without waiting.
+        if (dynamicResolution) {
+            glFinish();
+            gettimeofday(&renderEnd, NULL);
+            timersub(&renderEnd, &renderStart, &elapsed);
+            float renderMillis = (elapsed.tv_sec * 1000000 + elapsed.tv_usec) / 1000.0f;
+
+            perf_counters_stage(&perfCounters, "finish");
+            alloc_track_stage("finish");
+
+            resolution_update(&resolution, renderMillis);
+            antialias_record(&antialias, renderMillis);
+        }
+
         swap_buffers();
+
+        perf_counters_stage(&perfCounters, "swap");
+        alloc_track_stage("swap");
+        perf_counters_frame(&perfCounters);
+        alloc_track_frame();
+
+        clock_gettime(CLOCK_MONOTONIC, &swapTime[0]);
+        if (!firstFrame) {
+            float frameMillis = (swapTime[0].tv_sec - swapTime[1].tv_sec) * 1000.0f + (swapTime[0].tv_nsec - swapTime[1].tv_nsec) / 1e6f;
+            jitter_frame(&jitter, frameMillis);
+            metrics_frame(&metrics, frameMillis);
+        }
+        swapTime[1] = swapTime[0];
+
+        if (metrics.enabled) {
+            if (mouse) {
+                record_input_latency(&scene->mouseEvent, &mouseConsumed, &swapTime[0]);
+            }
+            if (keyboard) {
+                record_input_latency(&scene->keyboardEvent, &keyboardConsumed, &swapTime[0]);
+            }
+        }
+
+        __atomic_store_n(&drawnSequence, scene->sequence, __ATOMIC_RELEASE);
+        if (lockstep) {
+            lockstep_signal();
+        }
+
+        if (firstFrame) {
+            startup_mark("first swap");
+            startup_report();
+            firstFrame = 0;
+
+            gettimeofday(&startTime, NULL);
+        } else {
+            frames++;
+        }
+
+        if (assertNoAlloc && frames == ALLOC_TRACK_WARMUP_FRAMES) {
+            alloc_track_arm();
+        }
+    }
+
+    __atomic_store_n(&quit, 1, __ATOMIC_RELEASE);
+    lockstep_signal();
+    pthread_join(simulationThread, NULL);
+
+    if ((frameLimit || replayPath) && frames) {
+        struct timeval endTime, elapsed;
+        gettimeofday(&endTime, NULL);
+        timersub(&endTime, &startTime, &elapsed);
+
+        double seconds = elapsed.tv_sec + elapsed.tv_usec / 1e6;
+        printf("Frames: %u in %.3f s, %.2f FPS, %.3f ms/frame\n", frames, seconds, frames / seconds, 1000 * seconds / frames);
+    }
+    jitter_report(&jitter, realtime.enabled ? "realtime" : "normal");
+    if (simClock.droppedSeconds > 0) {
+        printf("Sim: %llu steps, %.3f s dropped by the catch-up cap\n", (unsigned long long)simClock.steps, simClock.droppedSeconds);
     }
 
     // Teardown
 
+    if (dynamicResolution) {
+        resolution_destroy(&resolution);
+    }
+    antialias_destroy(&antialias);
+    gpu_profile_destroy(&gpuProfile);
+    if (perf) {
+        perf_counters_destroy(&perfCounters);
+    }
+    metrics_destroy(&metrics);
+    if (jobWorkers >= 0) {
+        jobs_destroy(&jobSystem);
+    }
     destroy_textures();
+#ifdef HAVE_GLES3
+    if (window->glesVersion >= 3) {
+        destroy_vertex_arrays();
+    }
+#endif
     destroy_buffers();
     destroy_shaders();
+    instances_destroy(&instances);
+
+    window_destroy(window);
 
-    mouse_destroy(mouse);
-    keyboard_destroy(keyboard);
+    if (mouse) {
+        mouse_destroy(mouse);
+    }
+    if (keyboard) {
+        keyboard_destroy(keyboard);
+    }
     free(mouse);
     free(keyboard);
     free(window);
+    input_log_close();
+
+    // Everything created above should be gone by now.
+    gl_resources_report_leaks();
+    gl_debug_destroy();
+
+    trace_export();
+
+    if (alloc_track_violations()) {
+        fprintf(stderr, "AllocTrack: %u allocations after warmup\n", alloc_track_violations());
+        return 1;
+    }
 }
\ No newline at end of file
@@ -1,5 +1,27 @@
 #include "matrix.h"
 
+// Results are built in temporaries on the stack and copied out, so passing
+// a destination (which may also be a source) never allocates; only a NULL
+// destination returns a newly allocated result.
+
+static GLfloat* mat3_copy(GLfloat* mat3d, const GLfloat* mat3s) {
+    if (!mat3d)
+        mat3d = NEW(GLfloat, 9);
+
+    memcpy(mat3d, mat3s, 9*sizeof(GLfloat));
+
+    return mat3d;
+}
+
+static GLfloat* mat4_copy(GLfloat* mat4d, const GLfloat* mat4s) {
+    if (!mat4d)
+        mat4d = NEW(GLfloat, 16);
+
+    memcpy(mat4d, mat4s, 16*sizeof(GLfloat));
+
+    return mat4d;
+}
+
 GLfloat* mat4_identity(GLfloat* mat4d) {
     GLfloat* mat4i = mat4d ? mat4d : NEW(GLfloat, 16);
 
@@ -10,26 +32,20 @@ GLfloat* mat4_identity(GLfloat* mat4d) {
 }
 
 GLfloat* mat4_translate(GLfloat* mat4d, GLfloat* mat4s, GLfloat* vec3) {
-    GLfloat* mat4t = mat4_identity(NULL);
+    GLfloat mat4t[16];
+    mat4_identity(mat4t);
 
     for (unsigned i=0; i<3; i++)
         mat4t[12+i] = vec3[i];
 
     if (mat4s)
         mat4_multiply(mat4t, mat4s, mat4t);
-    
-    if (mat4d) {
-        memcpy(mat4d, mat4t, 16*sizeof(GLfloat));
-        free(mat4t);
-    } else {
-        mat4d = mat4t;
-    }
 
-    return mat4d;
+    return mat4_copy(mat4d, mat4t);
 }
 
 GLfloat* mat4_rotate(GLfloat* mat4d, GLfloat* mat4s, GLfloat radians, GLfloat* vec3) {
-    GLfloat* mat4r = mat4_identity(NULL);
+    GLfloat mat4r[16];
 
     GLfloat u = vec3[0];
     GLfloat v = vec3[1];
@@ -64,32 +80,18 @@ GLfloat* mat4_rotate(GLfloat* mat4d, GLfloat* mat4s, GLfloat radians, GLfloat* v
 
     if (mat4s)
         mat4_multiply(mat4r, mat4s, mat4r);
-    
-    if (mat4d) {
-        memcpy(mat4d, mat4r, 16*sizeof(GLfloat));
-        free(mat4r);
-    } else {
-        mat4d = mat4r;
-    }
 
-    return mat4d;
+    return mat4_copy(mat4d, mat4r);
 }
 
 GLfloat* mat4_multiply(GLfloat* mat4d, GLfloat* mat4a, GLfloat* mat4b) {
-    GLfloat* mat4m = NEW(GLfloat, 16);
+    GLfloat mat4m[16];
 
     for (unsigned i=0; i<4; i++)
         for (unsigned j=0; j<4; j++)
             mat4m[i*4+j] = mat4a[i*4+0]*mat4b[0+j] + mat4a[i*4+1]*mat4b[4+j] + mat4a[i*4+2]*mat4b[8+j]  + mat4a[i*4+3]*mat4b[12+j];
-    
-    if (mat4d) {
-        memcpy(mat4d, mat4m, 16*sizeof(GLfloat));
-        free(mat4m);
-    } else {
-        mat4d = mat4m;
-    }
 
-    return mat4d;
+    return mat4_copy(mat4d, mat4m);
 }
 
 GLfloat* mat4_perspective(GLfloat* mat4d, double fov, double aspect, double near, double far) {
@@ -159,24 +161,17 @@ GLfloat* mat3_sub(GLfloat* mat2d, GLfloat* mat3s, int i) {
 }
 
 GLfloat* mat3_transpose(GLfloat* mat3d, GLfloat* mat3s) {
-    GLfloat* mat3t = NEW(GLfloat, 9);
+    GLfloat mat3t[9];
 
     for (unsigned i=0; i<3; i++)
         for (unsigned j=0; j<3; j++)
             mat3t[i*3+j] = mat3s[j*3+i];
-    
-    if (mat3d) {
-        memcpy(mat3d, mat3t, 9*sizeof(GLfloat));
-        free(mat3t);
-    } else {
-        mat3d = mat3t;
-    }
 
-    return mat3d;
+    return mat3_copy(mat3d, mat3t);
 }
 
 GLfloat* mat3_inverse(GLfloat* mat3d, GLfloat* mat3s) {
-    GLfloat* mat3m = NEW(GLfloat, 9);
+    GLfloat  mat3m[9];
     GLfloat  mat2[4];
 
     for (unsigned i=0; i<9; i++) {
@@ -198,14 +193,7 @@ GLfloat* mat3_inverse(GLfloat* mat3d, GLfloat* mat3s) {
     for (unsigned i=0; i<9; i++)
         mat3m[i] /= det;
 
-    if (mat3d) {
-        memcpy(mat3d, mat3m, 9*sizeof(GLfloat));
-        free(mat3m);
-    } else {
-        mat3d = mat3m;
-    }
-
-    return mat3d;
+    return mat3_copy(mat3d, mat3m);
 }
 
 GLfloat mat3_determinate(GLfloat* mat3s) {
@@ -249,25 +237,18 @@ GLfloat* mat4_sub(GLfloat* mat3d, GLfloat* mat4s, int i) {
 }
 
 GLfloat* mat4_transpose(GLfloat* mat4d, GLfloat* mat4s) {
-    GLfloat* mat4t = NEW(GLfloat, 16);
+    GLfloat mat4t[16];
 
     for (unsigned i=0; i<4; i++)
         for (unsigned j=0; j<4; j++)
             mat4t[i*4+j] = mat4s[j*4+i];
-    
-    if (mat4d) {
-        memcpy(mat4d, mat4t, 16*sizeof(GLfloat));
-        free(mat4t);
-    } else {
-        mat4d = mat4t;
-    }
 
-    return mat4d;
+    return mat4_copy(mat4d, mat4t);
 }
 
 
 GLfloat* mat4_inverse(GLfloat* mat4d, GLfloat* mat4s) {
-    GLfloat* mat4m = NEW(GLfloat, 16);
+    GLfloat  mat4m[16];
     GLfloat  mat3[9];
 
     for (unsigned i=0; i<16; i++) {
@@ -295,14 +276,7 @@ GLfloat* mat4_inverse(GLfloat* mat4d, GLfloat* mat4s) {
     for (unsigned i=0; i<16; i++)
         mat4m[i] /= det;
 
-    if (mat4d) {
-        memcpy(mat4d, mat4m, 16*sizeof(GLfloat));
-        free(mat4m);
-    } else {
-        mat4d = mat4m;
-    }
-
-    return mat4d;
+    return mat4_copy(mat4d, mat4m);
 }
 
 GLfloat mat4_determinate(GLfloat* mat4s) {
@@ -338,52 +312,42 @@ GLfloat* vec3_scale(GLfloat* vec3d, GLfloat* vec3s, GLfloat m) {
 }
 
 GLfloat* vec3_transform(GLfloat* vec3d, GLfloat* mat4, GLfloat* vec3s) {
-    GLfloat* vec3t  = NEW(GLfloat, 3);
+    GLfloat vec3t[3];
 
     for (unsigned i=0; i<3; i++)
         vec3t[i] = vec3s[0]*mat4[i+0] + vec3s[1]*mat4[i+4] + vec3s[2]*mat4[i+8] + mat4[i+12];
 
-    if (vec3d) {
-        memcpy(vec3d, vec3t, 3*sizeof(GLfloat));
-        free(vec3t);
-    } else {
-        vec3d = vec3t;
-    }
+    if (!vec3d)
+        vec3d = NEW(GLfloat, 3);
+
+    memcpy(vec3d, vec3t, 3*sizeof(GLfloat));
 
     return vec3d;
 }
 
 GLfloat* vec3_normalize(GLfloat* vec3d, GLfloat* vec3s) {
-    GLfloat* vec3n  = NEW(GLfloat, 3);
-    memcpy(vec3n, vec3s, 3*sizeof(GLfloat));
-
     GLfloat length = sqrt(pow(vec3s[0], 2) + pow(vec3s[1], 2) + pow(vec3s[2], 2));
 
-    for (int i=0; i<3; i++)
-        vec3n[i] /= length;
+    if (!vec3d)
+        vec3d = NEW(GLfloat, 3);
 
-    if (vec3d) {
-        memcpy(vec3d, vec3n, 3*sizeof(GLfloat));
-        free(vec3n);
-    } else {
-        vec3d = vec3n;
-    }
+    // vec3d may be vec3s, so the length is taken first.
+    for (int i=0; i<3; i++)
+        vec3d[i] = vec3s[i] / length;
 
-    return vec3n;
+    return vec3d;
 }
 
 GLfloat* vec4_transform(GLfloat* vec4d, GLfloat* mat4, GLfloat* vec4s) {
-    GLfloat* vec4t  = NEW(GLfloat, 4);
+    GLfloat vec4t[4];
 
     for (unsigned i=0; i<4; i++)
         vec4t[i] = vec4s[0]*mat4[i+0] + vec4s[1]*mat4[i+4] + vec4s[2]*mat4[i+8] + vec4s[3]*mat4[i+12];
 
-    if (vec4d) {
-        memcpy(vec4d, vec4t, 4*sizeof(GLfloat));
-        free(vec4t);
-    } else {
-        vec4d = vec4t;
-    }
+    if (!vec4d)
+        vec4d = NEW(GLfloat, 4);
+
+    memcpy(vec4d, vec4t, 4*sizeof(GLfloat));
 
     return vec4d;
 }
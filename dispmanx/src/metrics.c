@@ -0,0 +1,190 @@
+#include "metrics.h"
+#include "glresources.h"
+
+static const float bucketMillis[METRICS_BUCKETS] = { 4, 8, 12, 16.7f, 20, 25, 33.3f, 50, 66.7f, 100, INFINITY };
+
+static uint64_t read_rss(Metrics* metrics) {
+    // statm stays open, and is read without stdio, so publishing doesn't
+    // allocate.
+    char buffer[64];
+    ssize_t n = metrics->statmFd >= 0 ? pread(metrics->statmFd, buffer, sizeof(buffer) - 1, 0) : -1;
+    if (n <= 0) {
+        return 0;
+    }
+    buffer[n] = 0;
+
+    // size resident shared text lib data dt, in pages
+    char* resident = strchr(buffer, ' ');
+    return resident ? strtoull(resident + 1, NULL, 10) * sysconf(_SC_PAGESIZE) : 0;
+}
+
+static void publish(Metrics* metrics, const struct timespec* now) {
+    MetricsSegment* segment = metrics->segment;
+
+    float intervalSeconds = (now->tv_sec - metrics->publishTime.tv_sec) + (now->tv_nsec - metrics->publishTime.tv_nsec) / 1e9f;
+    uint64_t rssBytes = read_rss(metrics);
+
+    // Odd while writing; the release fence keeps the field stores after it.
+    uint32_t sequence = segment->sequence;
+    __atomic_store_n(&segment->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    segment->publishNanos = (uint64_t)now->tv_sec * 1000000000 + now->tv_nsec;
+    segment->intervalSeconds = intervalSeconds;
+
+    segment->frames = metrics->frames;
+    segment->droppedFrames = metrics->droppedFrames;
+    memcpy(segment->histogram, metrics->histogram, sizeof(segment->histogram));
+    segment->frameMillisMean = metrics->intervalFrames ? metrics->frameMillisSum / metrics->intervalFrames : 0;
+    segment->frameMillisMax = metrics->frameMillisMax;
+
+    segment->inputEvents = metrics->inputEvents;
+    segment->inputLatencyMillisMean = metrics->inputEvents ? metrics->inputLatencyMillisSum / metrics->inputEvents : 0;
+    segment->inputLatencyMillisMax = metrics->inputLatencyMillisMax;
+
+    segment->rssBytes = rssBytes;
+
+    segment->glPrograms = gl_resources_count(GL_RESOURCE_PROGRAM);
+    segment->glBuffers = gl_resources_count(GL_RESOURCE_BUFFER);
+    segment->glTextures = gl_resources_count(GL_RESOURCE_TEXTURE);
+    segment->glRenderbuffers = gl_resources_count(GL_RESOURCE_RENDERBUFFER);
+    segment->glFramebuffers = gl_resources_count(GL_RESOURCE_FRAMEBUFFER);
+    segment->glBytes = gl_resources_bytes();
+
+    __atomic_store_n(&segment->sequence, sequence + 2, __ATOMIC_RELEASE);
+
+    // The histogram and means cover one interval; the frame counts don't.
+    memset(metrics->histogram, 0, sizeof(metrics->histogram));
+    metrics->intervalFrames = 0;
+    metrics->frameMillisSum = 0;
+    metrics->frameMillisMax = 0;
+    metrics->inputEvents = 0;
+    metrics->inputLatencyMillisSum = 0;
+    metrics->inputLatencyMillisMax = 0;
+    metrics->publishTime = *now;
+}
+
+Metrics* metrics_init(Metrics* m, const char* name) {
+    Metrics* metrics = m ? m : NEW(Metrics, 1);
+    memset(metrics, 0, sizeof(Metrics));
+
+    snprintf(metrics->name, sizeof(metrics->name), "%s", name);
+
+    metrics->fd = shm_open(metrics->name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (metrics->fd < 0) {
+        perror("Metrics: unable to create shared memory");
+        return metrics;
+    }
+
+    if (ftruncate(metrics->fd, sizeof(MetricsSegment)) < 0) {
+        perror("Metrics: unable to size shared memory");
+        close(metrics->fd);
+        shm_unlink(metrics->name);
+        return metrics;
+    }
+
+    metrics->segment = mmap(NULL, sizeof(MetricsSegment), PROT_READ | PROT_WRITE, MAP_SHARED, metrics->fd, 0);
+    if (metrics->segment == MAP_FAILED) {
+        perror("Metrics: unable to map shared memory");
+        metrics->segment = NULL;
+        close(metrics->fd);
+        shm_unlink(metrics->name);
+        return metrics;
+    }
+
+    // The segment is zero-filled by ftruncate, so the sequence starts even.
+    metrics->segment->pid = getpid();
+    metrics->segment->size = sizeof(MetricsSegment);
+    memcpy(metrics->segment->bucketMillis, bucketMillis, sizeof(bucketMillis));
+    metrics->segment->version = METRICS_VERSION;
+    __atomic_store_n(&metrics->segment->magic, METRICS_MAGIC, __ATOMIC_RELEASE);
+
+    metrics->statmFd = open("/proc/self/statm", O_RDONLY);
+
+    clock_gettime(CLOCK_MONOTONIC, &metrics->publishTime);
+    metrics->enabled = 1;
+
+    printf("Metrics: publishing to shared memory %s every %d s\n", metrics->name, METRICS_PUBLISH_SECONDS);
+
+    return metrics;
+}
+
+void metrics_destroy(Metrics* metrics) {
+    if (!metrics->enabled) {
+        return;
+    }
+
+    munmap(metrics->segment, sizeof(MetricsSegment));
+    close(metrics->fd);
+    if (metrics->statmFd >= 0) {
+        close(metrics->statmFd);
+    }
+
+    // Readers that still have it mapped keep the last snapshot.
+    shm_unlink(metrics->name);
+
+    metrics->segment = NULL;
+    metrics->enabled = 0;
+}
+
+void metrics_set_refresh(Metrics* metrics, float refreshHz) {
+    if (!metrics->enabled || refreshHz <= 0) {
+        return;
+    }
+
+    metrics->refreshMillis = 1000 / refreshHz;
+    printf("Metrics: refresh period %.3f ms, from the display mode\n", metrics->refreshMillis);
+}
+
+void metrics_input(Metrics* metrics, float latencyMillis) {
+    if (!metrics->enabled) {
+        return;
+    }
+
+    metrics->inputEvents++;
+    metrics->inputLatencyMillisSum += latencyMillis;
+    if (latencyMillis > metrics->inputLatencyMillisMax) {
+        metrics->inputLatencyMillisMax = latencyMillis;
+    }
+}
+
+void metrics_frame(Metrics* metrics, float frameMillis) {
+    if (!metrics->enabled) {
+        return;
+    }
+
+    metrics->frames++;
+
+    // A frame that took half a refresh longer than it should have missed at
+    // least one vertical sync.
+    if (!metrics->refreshMillis) {
+        if (!metrics->shortestMillis || frameMillis < metrics->shortestMillis) {
+            metrics->shortestMillis = frameMillis;
+        }
+        if (++metrics->calibrationFrames == METRICS_CALIBRATION_FRAMES) {
+            metrics->refreshMillis = metrics->shortestMillis;
+            printf("Metrics: refresh period %.3f ms, measured\n", metrics->refreshMillis);
+        }
+    } else if (frameMillis > METRICS_DROP_FACTOR * metrics->refreshMillis) {
+        metrics->droppedFrames++;
+    }
+
+    unsigned bucket = 0;
+    while (bucket < METRICS_BUCKETS - 1 && frameMillis > bucketMillis[bucket]) {
+        bucket++;
+    }
+    metrics->histogram[bucket]++;
+
+    metrics->intervalFrames++;
+    metrics->frameMillisSum += frameMillis;
+    if (frameMillis > metrics->frameMillisMax) {
+        metrics->frameMillisMax = frameMillis;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    int64_t elapsedNanos = (int64_t)(now.tv_sec - metrics->publishTime.tv_sec) * 1000000000 + (now.tv_nsec - metrics->publishTime.tv_nsec);
+    if (elapsedNanos >= (int64_t)METRICS_PUBLISH_SECONDS * 1000000000) {
+        publish(metrics, &now);
+    }
+}
@@ -0,0 +1,106 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "global.h"
+
+#define METRICS_DEFAULT_NAME                          "/hello-triangle"
+#define METRICS_MAGIC                                         0x4d545448 // "HTTM"
+#define METRICS_VERSION                                                2
+#define METRICS_BUCKETS                                               11
+#define METRICS_PUBLISH_SECONDS                                        1
+#define METRICS_CALIBRATION_FRAMES                                    60
+#define METRICS_DROP_FACTOR                                         1.5f
+
+// The shared-memory segment, as seen by both the renderer and the reader.
+// The header is written once when the segment is created; everything after
+// sequence is protected by it as a seqlock. The writer makes sequence odd,
+// updates the fields and makes it even again, so a reader that sees the same
+// even value before and after copying the fields has a consistent snapshot.
+// Any change to the layout bumps METRICS_VERSION.
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;
+    uint32_t pid;
+    float bucketMillis[METRICS_BUCKETS];      // upper bounds; the last is +inf
+
+    uint32_t sequence;
+
+    uint64_t publishNanos;                    // CLOCK_MONOTONIC
+    float intervalSeconds;
+
+    uint64_t frames;                          // since startup
+    uint64_t droppedFrames;                   // since startup
+    uint32_t histogram[METRICS_BUCKETS];      // frame times in the last interval
+    float frameMillisMean;
+    float frameMillisMax;
+
+    uint32_t inputEvents;                     // in the last interval
+    float inputLatencyMillisMean;
+    float inputLatencyMillisMax;
+
+    uint64_t rssBytes;
+
+    uint32_t glPrograms;
+    uint32_t glBuffers;
+    uint32_t glTextures;
+    uint32_t glRenderbuffers;
+    uint32_t glFramebuffers;
+    uint64_t glBytes;                         // estimated
+} MetricsSegment;
+
+// Publishes the frame loop's figures to a POSIX shared-memory segment once a
+// second, for a monitoring agent to read without talking to the process.
+// The writer never blocks on readers. If the segment can't be created every
+// call does nothing.
+typedef struct {
+    char enabled;
+    char name[64];
+    int fd;
+    int statmFd;
+    MetricsSegment* segment;
+
+    struct timespec publishTime;
+    uint64_t frames;
+    uint64_t droppedFrames;
+    uint32_t histogram[METRICS_BUCKETS];
+    unsigned intervalFrames;
+    float frameMillisSum;
+    float frameMillisMax;
+    unsigned inputEvents;
+    float inputLatencyMillisSum;
+    float inputLatencyMillisMax;
+
+    // The refresh period dropped frames are judged by; 0 while it is still
+    // being measured from the first frames.
+    float refreshMillis;
+    unsigned calibrationFrames;
+    float shortestMillis;
+} Metrics;
+
+Metrics* metrics_init(Metrics* m, const char* name);
+void metrics_destroy(Metrics* metrics);
+
+// Sets the display's refresh rate. Without one, the period is taken as the
+// shortest of the first METRICS_CALIBRATION_FRAMES frames, which vsync
+// holds to one refresh.
+void metrics_set_refresh(Metrics* metrics, float refreshHz);
+
+// Records the time from an input event to the swap that presented it.
+void metrics_input(Metrics* metrics, float latencyMillis);
+
+// Records one frame, swap to swap, and publishes when a second has passed.
+void metrics_frame(Metrics* metrics, float frameMillis);
+
+#endif // METRICS_H
@@ -0,0 +1,133 @@
+// hello-triangle-metrics [--follow] [NAME]
+//
+// Reads the metrics a running hello-triangle publishes with --metrics and
+// prints them as JSON: once, or with --follow as one line per update until
+// the renderer goes away. NAME defaults to METRICS_DEFAULT_NAME.
+
+#include <errno.h>
+#include <signal.h>
+
+#include "metrics.h"
+
+#define READ_ATTEMPTS                                               1000
+#define FOLLOW_POLL_MICROS                                        100000
+
+// Copies a consistent snapshot out of the segment, retrying while the
+// writer is part way through an update. Returns 0 if the writer never let
+// go, e.g. because it died while holding the sequence odd.
+static int read_snapshot(const MetricsSegment* segment, MetricsSegment* snapshot) {
+    for (unsigned attempt = 0; attempt < READ_ATTEMPTS; attempt++) {
+        uint32_t before = __atomic_load_n(&segment->sequence, __ATOMIC_ACQUIRE);
+        if (before & 1) {
+            usleep(10);
+            continue;
+        }
+
+        memcpy(snapshot, segment, sizeof(MetricsSegment));
+
+        // Keeps the copy before the second load of the sequence.
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        uint32_t after = __atomic_load_n(&segment->sequence, __ATOMIC_RELAXED);
+        if (before == after) {
+            snapshot->sequence = before;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static void print_json(const MetricsSegment* s) {
+    printf("{\"pid\":%u,\"sequence\":%u,\"publish_ns\":%llu,\"interval_s\":%.3f,"
+           "\"frames\":%llu,\"dropped_frames\":%llu,",
+           s->pid, s->sequence / 2, (unsigned long long)s->publishNanos, s->intervalSeconds,
+           (unsigned long long)s->frames, (unsigned long long)s->droppedFrames);
+
+    printf("\"frame_ms\":{\"mean\":%.3f,\"max\":%.3f,\"histogram\":[", s->frameMillisMean, s->frameMillisMax);
+    for (unsigned i = 0; i < METRICS_BUCKETS; i++) {
+        if (isinf(s->bucketMillis[i])) {
+            printf("%s{\"le\":\"+Inf\",\"count\":%u}", i ? "," : "", s->histogram[i]);
+        } else {
+            printf("%s{\"le\":%g,\"count\":%u}", i ? "," : "", s->bucketMillis[i], s->histogram[i]);
+        }
+    }
+    printf("]},");
+
+    printf("\"input_latency_ms\":{\"events\":%u,\"mean\":%.3f,\"max\":%.3f},",
+           s->inputEvents, s->inputLatencyMillisMean, s->inputLatencyMillisMax);
+
+    printf("\"rss_bytes\":%llu,", (unsigned long long)s->rssBytes);
+
+    printf("\"gl\":{\"programs\":%u,\"buffers\":%u,\"textures\":%u,\"renderbuffers\":%u,\"framebuffers\":%u,\"bytes\":%llu}}\n",
+           s->glPrograms, s->glBuffers, s->glTextures, s->glRenderbuffers, s->glFramebuffers, (unsigned long long)s->glBytes);
+
+    fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+    const char* name = METRICS_DEFAULT_NAME;
+    char follow = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--follow")) {
+            follow = 1;
+        } else {
+            name = argv[i];
+        }
+    }
+
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        fprintf(stderr, "Metrics: unable to open shared memory %s: %s\n", name, strerror(errno));
+        return 1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(MetricsSegment)) {
+        fprintf(stderr, "Metrics: %s is too small for version %d\n", name, METRICS_VERSION);
+        return 1;
+    }
+
+    const MetricsSegment* segment = mmap(NULL, sizeof(MetricsSegment), PROT_READ, MAP_SHARED, fd, 0);
+    if (segment == MAP_FAILED) {
+        perror("Metrics: unable to map shared memory");
+        return 1;
+    }
+
+    if (__atomic_load_n(&segment->magic, __ATOMIC_ACQUIRE) != METRICS_MAGIC) {
+        fprintf(stderr, "Metrics: %s is not a metrics segment\n", name);
+        return 1;
+    }
+    if (segment->version != METRICS_VERSION || segment->size != sizeof(MetricsSegment)) {
+        fprintf(stderr, "Metrics: %s has version %u, expected %d\n", name, segment->version, METRICS_VERSION);
+        return 1;
+    }
+
+    MetricsSegment snapshot;
+    uint32_t printed = 0;
+
+    while (1) {
+        if (!read_snapshot(segment, &snapshot)) {
+            fprintf(stderr, "Metrics: the writer never finished an update\n");
+            return 1;
+        }
+
+        // Nothing is printed until the first update.
+        if (snapshot.sequence != printed) {
+            print_json(&snapshot);
+            printed = snapshot.sequence;
+
+            if (!follow) {
+                return 0;
+            }
+        }
+
+        // The renderer unlinks the segment on exit; a stale mapping would
+        // otherwise be followed forever.
+        if (kill(snapshot.pid, 0) < 0 && errno == ESRCH) {
+            return follow ? 0 : 1;
+        }
+
+        usleep(FOLLOW_POLL_MICROS);
+    }
+}
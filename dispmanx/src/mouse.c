@@ -1,4 +1,6 @@
 #include "mouse.h"
+#include "trace.h"
+#include "inputlog.h"
 
 Mouse* mouse_init(Mouse* m, const char* devicePath) {
     Mouse* mouse = m ? m : NEW(Mouse, 1);
@@ -8,9 +10,23 @@ Mouse* mouse_init(Mouse* m, const char* devicePath) {
     mouse->fd = open(devicePath, O_RDONLY | O_NONBLOCK);
     if (mouse->fd == -1) {
         perror("Mouse: unable to open device.");
+        if (!m) {
+            free(mouse);
+        }
         return NULL;
     }
 
+    // Event times are on the realtime clock by default, which can jump.
+    int clockId = CLOCK_MONOTONIC;
+    if (ioctl(mouse->fd, EVIOCSCLOCKID, &clockId) == -1) {
+        // ENOTTY is a replay's pipe, not a device; its events are stamped
+        // on the realtime clock too.
+        if (errno != ENOTTY) {
+            fprintf(stderr, "Mouse: unable to set the event clock (%s), converting from CLOCK_REALTIME\n", strerror(errno));
+        }
+        mouse->realtimeClock = 1;
+    }
+
     return mouse;
 }
 
@@ -19,9 +35,13 @@ void mouse_destroy(Mouse* mouse) {
 }
 
 void mouse_process_events(Mouse* mouse) {
+    TRACE_SCOPE("mouse_process_events");
+
     int n;
     struct input_event inputEvent;
     while ((n = read(mouse->fd, (void*)&inputEvent, sizeof(struct input_event))) > 0) {
+        input_log_event(INPUT_LOG_MOUSE, &inputEvent);
+        mouse->lastEvent = mouse->realtimeClock ? input_log_monotonic_time(inputEvent.time) : inputEvent.time;
         if (inputEvent.type == EV_REL) {     
             if (inputEvent.code == 0) {
                 mouse->x += inputEvent.value;
@@ -9,6 +9,10 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/ioctl.h>
+#include <sys/time.h>
 #include <linux/input.h>
 
 #include "global.h"
@@ -18,6 +22,13 @@ typedef struct {
     char buttons;
     int x;
     int y;
+
+    // Time of the latest event, on CLOCK_MONOTONIC
+    struct timeval lastEvent;
+
+    // Set when the device wouldn't switch clocks, so event times are on
+    // CLOCK_REALTIME and are converted.
+    char realtimeClock;
 } Mouse;
 
 Mouse* mouse_init(Mouse* m, const char* devicePath);
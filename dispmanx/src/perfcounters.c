@@ -0,0 +1,177 @@
+#include "perfcounters.h"
+
+static const char* names[] = { "cycles", "instructions", "cache-misses", "branch-misses", "context-switches" };
+
+static const struct {
+    uint32_t type;
+    uint64_t config;
+} events[] = {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES },
+};
+
+// The first counter opened leads the group; the rest join it.
+static int open_counter(PerfCounters* perf, PerfCounter counter, int leader) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = events[counter].type;
+    attr.config = events[counter].config;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.disabled = leader < 0;
+    attr.exclude_kernel = perf->excludeKernel;
+    attr.exclude_hv = perf->excludeKernel;
+
+    // This thread, on any CPU. Counting the kernel's share too needs a
+    // permissive perf_event_paranoid; fall back to user space only, for
+    // the whole group.
+    int fd = syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+    if (fd < 0 && leader < 0 && !perf->excludeKernel && (errno == EACCES || errno == EPERM)) {
+        perf->excludeKernel = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+    }
+
+    return fd;
+}
+
+static int leader_fd(PerfCounters* perf) {
+    for (unsigned i = 0; i < PERF_COUNTER_COUNT; i++) {
+        if (perf->slots[i] == 0) {
+            return perf->fds[i];
+        }
+    }
+
+    return -1;
+}
+
+static void read_counters(PerfCounters* perf, uint64_t* values) {
+    // nr, time enabled, time running, then a value per member in the order
+    // they joined.
+    uint64_t group[3 + PERF_COUNTER_COUNT];
+    size_t size = (3 + perf->groupSize) * sizeof(uint64_t);
+
+    memset(values, 0, PERF_COUNTER_COUNT * sizeof(uint64_t));
+    if (read(leader_fd(perf), group, size) != (ssize_t)size || !group[2]) {
+        return;
+    }
+
+    double scale = (double)group[1] / group[2];
+    for (unsigned i = 0; i < PERF_COUNTER_COUNT; i++) {
+        if (perf->slots[i] >= 0) {
+            values[i] = group[3 + perf->slots[i]] * scale;
+        }
+    }
+}
+
+PerfCounters* perf_counters_init(PerfCounters* p) {
+    PerfCounters* perf = p ? p : NEW(PerfCounters, 1);
+    memset(perf, 0, sizeof(PerfCounters));
+
+    int leader = -1;
+
+    printf("Perf:");
+    for (unsigned i = 0; i < PERF_COUNTER_COUNT; i++) {
+        perf->fds[i] = open_counter(perf, i, leader);
+        perf->slots[i] = -1;
+        if (perf->fds[i] >= 0) {
+            if (leader < 0) {
+                leader = perf->fds[i];
+            }
+            perf->slots[i] = perf->groupSize++;
+        }
+        printf(" %s %s", names[i], perf->fds[i] >= 0 ? "on" : "unavailable");
+    }
+    printf("\n");
+
+    if (leader >= 0) {
+        ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        perf->enabled = 1;
+    }
+
+    if (!perf->enabled) {
+        fprintf(stderr, "Perf: no counters available (%s); see /proc/sys/kernel/perf_event_paranoid\n", strerror(errno));
+    }
+
+    return perf;
+}
+
+void perf_counters_destroy(PerfCounters* perf) {
+    // Members first; the group goes with its leader.
+    for (int i = PERF_COUNTER_COUNT - 1; i >= 0; i--) {
+        if (perf->fds[i] >= 0) {
+            close(perf->fds[i]);
+            perf->fds[i] = -1;
+        }
+        perf->slots[i] = -1;
+    }
+    perf->groupSize = 0;
+    perf->enabled = 0;
+}
+
+void perf_counters_begin(PerfCounters* perf) {
+    if (!perf->enabled) {
+        return;
+    }
+
+    read_counters(perf, perf->last);
+}
+
+void perf_counters_stage(PerfCounters* perf, const char* stage) {
+    if (!perf->enabled) {
+        return;
+    }
+
+    uint64_t now[PERF_COUNTER_COUNT];
+    read_counters(perf, now);
+
+    unsigned s = 0;
+    while (s < perf->stageCount && perf->stages[s] != stage) {
+        s++;
+    }
+    if (s == perf->stageCount) {
+        if (s == PERF_COUNTERS_MAX_STAGES) {
+            memcpy(perf->last, now, sizeof(now));
+            return;
+        }
+        perf->stages[perf->stageCount++] = stage;
+    }
+
+    for (unsigned i = 0; i < PERF_COUNTER_COUNT; i++) {
+        perf->totals[s][i] += now[i] - perf->last[i];
+    }
+
+    memcpy(perf->last, now, sizeof(now));
+}
+
+void perf_counters_frame(PerfCounters* perf) {
+    if (!perf->enabled || ++perf->reportFrames < PERF_COUNTERS_REPORT_FRAMES) {
+        return;
+    }
+
+    // Miss rates are per thousand instructions, so stages of very different
+    // length compare directly.
+    printf("Perf: per frame over %u frames\n", perf->reportFrames);
+    printf("  %-12s %12s %6s %11s %11s %8s\n", "stage", "cycles", "IPC", "cache MPKI", "branch MPKI", "cswitch");
+
+    for (unsigned s = 0; s < perf->stageCount; s++) {
+        uint64_t* totals = perf->totals[s];
+        double kiloInstructions = totals[PERF_INSTRUCTIONS] / 1e3;
+
+        printf("  %-12s %12.0f %6.2f %11.2f %11.2f %8.2f\n", perf->stages[s],
+            (double)totals[PERF_CYCLES] / perf->reportFrames,
+            totals[PERF_CYCLES] ? (double)totals[PERF_INSTRUCTIONS] / totals[PERF_CYCLES] : 0,
+            kiloInstructions > 0 ? totals[PERF_CACHE_MISSES] / kiloInstructions : 0,
+            kiloInstructions > 0 ? totals[PERF_BRANCH_MISSES] / kiloInstructions : 0,
+            (double)totals[PERF_CONTEXT_SWITCHES] / perf->reportFrames);
+
+        memset(totals, 0, sizeof(perf->totals[s]));
+    }
+
+    perf->reportFrames = 0;
+}
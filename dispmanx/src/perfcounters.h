@@ -0,0 +1,63 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "global.h"
+
+#define PERF_COUNTERS_MAX_STAGES                                       8
+#define PERF_COUNTERS_REPORT_FRAMES                                  120
+
+typedef enum {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_CACHE_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_CONTEXT_SWITCHES,
+    PERF_COUNTER_COUNT
+} PerfCounter;
+
+// Hardware counters for the calling thread, attributed to the stages of the
+// frame loop. The counters form one group, which the PMU always schedules
+// together, so ratios such as IPC compare counts from the same time; if it
+// multiplexes the group with others, counts are scaled up by the time it
+// was enabled over the time it ran. A counter the kernel or the CPU doesn't
+// offer (e.g. in a VM, or with perf_event_paranoid too high) is left out of
+// the group; with none available every call does nothing.
+typedef struct {
+    int fds[PERF_COUNTER_COUNT];
+    int slots[PERF_COUNTER_COUNT];  // position in the group's read, or -1
+    unsigned groupSize;
+    char excludeKernel;
+    char enabled;
+
+    const char* stages[PERF_COUNTERS_MAX_STAGES];
+    unsigned stageCount;
+
+    uint64_t last[PERF_COUNTER_COUNT];
+    uint64_t totals[PERF_COUNTERS_MAX_STAGES][PERF_COUNTER_COUNT];
+    unsigned reportFrames;
+} PerfCounters;
+
+PerfCounters* perf_counters_init(PerfCounters* p);
+void perf_counters_destroy(PerfCounters* perf);
+
+// Marks the start of a frame.
+void perf_counters_begin(PerfCounters* perf);
+
+// Attributes everything counted since the previous boundary to stage. Stages
+// are told apart by the name pointer, so use string literals.
+void perf_counters_stage(PerfCounters* perf, const char* stage);
+
+// Marks the end of a frame and prints the per-stage figures periodically.
+void perf_counters_frame(PerfCounters* perf);
+
+#endif // PERFCOUNTERS_H
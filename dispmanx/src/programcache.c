@@ -0,0 +1,278 @@
+#include "programcache.h"
+
+static uint64_t nanos() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static uint64_t fnv1a(uint64_t hash, const char* str) {
+    if (!str) str = "";
+
+    // Include the terminator so that adjacent strings can't run together
+    do {
+        hash ^= (unsigned char)*str;
+        hash *= 0x100000001b3ULL;
+    } while (*str++);
+
+    return hash;
+}
+
+static uint64_t program_cache_key(const GLchar* vertexSource, const GLchar* fragmentSource, const GLchar* defines) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    hash = fnv1a(hash, (const char*)glGetString(GL_VENDOR));
+    hash = fnv1a(hash, (const char*)glGetString(GL_RENDERER));
+    hash = fnv1a(hash, (const char*)glGetString(GL_VERSION));
+    hash = fnv1a(hash, defines);
+    hash = fnv1a(hash, vertexSource);
+    hash = fnv1a(hash, fragmentSource);
+
+    return hash;
+}
+
+static void program_cache_path(ProgramCache* cache, uint64_t key, char* path, size_t size) {
+    snprintf(path, size, "%s/%016llx.bin", cache->directory, (unsigned long long)key);
+}
+
+static GLuint compile_shader(GLenum type, const GLchar* source, const GLchar* defines) {
+    // Defines have to follow the #version directive.
+    GLint versionLength = 0;
+    if (!strncmp(source, "#version", 8)) {
+        const char* newline = strchr(source, '\n');
+        versionLength = newline ? newline + 1 - source : (GLint)strlen(source);
+    }
+
+    const GLchar* sources[] = { source, defines ? defines : "", source + versionLength };
+    const GLint lengths[] = { versionLength, -1, -1 };
+
+    GLuint shader = gl_resources_track(GL_RESOURCE_SHADER, glCreateShader(type), type == GL_VERTEX_SHADER ? "vertex shader" : "fragment shader");
+    glShaderSource(shader, 3, sources, lengths);
+    glCompileShader(shader);
+
+    GLint status;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status != GL_TRUE) {
+        GLchar log[1024];
+        glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+        fprintf(stderr, "Shader: compilation failed.\n%s\n", log);
+    }
+
+    return shader;
+}
+
+static GLuint compile_program(const GLchar* vertexSource, const GLchar* fragmentSource, const GLchar* defines) {
+    GLuint vertexShader = compile_shader(GL_VERTEX_SHADER, vertexSource, defines);
+    GLuint fragmentShader = compile_shader(GL_FRAGMENT_SHADER, fragmentSource, defines);
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+
+    GLint status;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE) {
+        GLchar log[1024];
+        glGetProgramInfoLog(program, sizeof(log), NULL, log);
+        fprintf(stderr, "Program: linking failed.\n%s\n", log);
+    }
+
+    // The program keeps the compiled code; the shader objects are no longer needed.
+    glDetachShader(program, vertexShader);
+    glDetachShader(program, fragmentShader);
+    gl_resources_delete(GL_RESOURCE_SHADER, &vertexShader);
+    gl_resources_delete(GL_RESOURCE_SHADER, &fragmentShader);
+
+    // Callers check for 0 rather than use a program that can't run.
+    if (status != GL_TRUE) {
+        glDeleteProgram(program);
+        program = 0;
+    }
+
+    glCheck();
+
+    return program;
+}
+
+static GLuint program_cache_load(ProgramCache* cache, const char* path, uint64_t* buildNanos) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return 0;
+    }
+
+    ProgramCacheHeader header;
+    GLuint program = 0;
+    void* binary = NULL;
+
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        header.magic != PROGRAM_CACHE_MAGIC ||
+        header.version != PROGRAM_CACHE_VERSION) {
+        goto done;
+    }
+
+    // The length comes from the file; a corrupt one mustn't size the
+    // allocation.
+    struct stat st;
+    if (fstat(fileno(file), &st) != 0 || header.length == 0 || header.length > st.st_size - sizeof(header)) {
+        goto done;
+    }
+
+    binary = malloc(header.length);
+    if (fread(binary, 1, header.length, file) != header.length) {
+        goto done;
+    }
+
+    program = glCreateProgram();
+    cache->programBinary(program, header.format, binary, header.length);
+
+    GLint status;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE) {
+        // The driver rejected the binary, e.g. after a driver update.
+        glDeleteProgram(program);
+        program = 0;
+        cache->rejections++;
+    }
+
+    *buildNanos = header.buildNanos;
+
+done:
+    // Clear any error raised by a rejected binary.
+    glGetError();
+
+    free(binary);
+    fclose(file);
+
+    return program;
+}
+
+static void program_cache_store(ProgramCache* cache, const char* path, GLuint program, uint64_t buildNanos) {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH_OES, &length);
+    if (length <= 0) {
+        return;
+    }
+
+    ProgramCacheHeader header = { PROGRAM_CACHE_MAGIC, PROGRAM_CACHE_VERSION, 0, 0, buildNanos };
+    void* binary = malloc(length);
+
+    GLenum format;
+    GLsizei written;
+    cache->getProgramBinary(program, length, &written, &format, binary);
+    header.format = format;
+    header.length = written;
+
+    // Write to a temporary file and rename it into place, so that a concurrent
+    // reader never sees a partially written binary.
+    char tmpPath[300];
+    snprintf(tmpPath, sizeof(tmpPath), "%s.%d.tmp", path, getpid());
+
+    FILE* file = fopen(tmpPath, "wb");
+    if (file) {
+        char ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                  fwrite(binary, 1, written, file) == (size_t)written;
+        fclose(file);
+
+        if (!ok || rename(tmpPath, path) != 0) {
+            remove(tmpPath);
+        }
+    }
+
+    free(binary);
+    glCheck();
+}
+
+static void make_directories(char* path) {
+    for (char* p = path + 1; *p; p++) {
+        if (*p == '/') {
+            *p = 0;
+            mkdir(path, 0755);
+            *p = '/';
+        }
+    }
+    mkdir(path, 0755);
+}
+
+ProgramCache* program_cache_init(ProgramCache* c, const char* directory) {
+    ProgramCache* cache = c ? c : NEW(ProgramCache, 1);
+
+    memset(cache, 0, sizeof(ProgramCache));
+
+    if (directory) {
+        snprintf(cache->directory, sizeof(cache->directory), "%s", directory);
+    } else if (getenv("XDG_CACHE_HOME")) {
+        snprintf(cache->directory, sizeof(cache->directory), "%s/hello-triangle", getenv("XDG_CACHE_HOME"));
+    } else if (getenv("HOME")) {
+        snprintf(cache->directory, sizeof(cache->directory), "%s/.cache/hello-triangle", getenv("HOME"));
+    } else {
+        return cache;
+    }
+
+    make_directories(cache->directory);
+
+    const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+    GLint formats = 0;
+    if (extensions && strstr(extensions, "GL_OES_get_program_binary")) {
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS_OES, &formats);
+    }
+
+    if (formats > 0) {
+        cache->getProgramBinary = (PFNGLGETPROGRAMBINARYOESPROC)eglGetProcAddress("glGetProgramBinaryOES");
+        cache->programBinary = (PFNGLPROGRAMBINARYOESPROC)eglGetProcAddress("glProgramBinaryOES");
+        cache->supported = cache->getProgramBinary && cache->programBinary;
+    }
+
+    glCheck();
+
+    return cache;
+}
+
+GLuint program_cache_build(ProgramCache* cache, const GLchar* vertexSource, const GLchar* fragmentSource, const GLchar* defines) {
+    if (!cache->supported) {
+        return compile_program(vertexSource, fragmentSource, defines);
+    }
+
+    char path[300];
+    program_cache_path(cache, program_cache_key(vertexSource, fragmentSource, defines), path, sizeof(path));
+
+    uint64_t start = nanos();
+    uint64_t buildNanos = 0;
+
+    GLuint program = program_cache_load(cache, path, &buildNanos);
+    if (program) {
+        uint64_t loadNanos = nanos() - start;
+
+        cache->hits++;
+        if (buildNanos > loadNanos) {
+            cache->millisSaved += (buildNanos - loadNanos) / 1e6;
+        }
+
+        return program;
+    }
+
+    cache->misses++;
+
+    start = nanos();
+    program = compile_program(vertexSource, fragmentSource, defines);
+    buildNanos = nanos() - start;
+
+    if (program) {
+        program_cache_store(cache, path, program, buildNanos);
+    }
+
+    return program;
+}
+
+void program_cache_report(ProgramCache* cache) {
+    if (!cache->supported) {
+        printf("Program cache: GL_OES_get_program_binary unavailable, programs compiled from source.\n");
+        return;
+    }
+
+    unsigned lookups = cache->hits + cache->misses;
+    printf("Program cache: %u hits, %u misses, %u rejected (%.0f%% hit rate), %.2f ms saved.\n",
+        cache->hits, cache->misses, cache->rejections,
+        lookups ? 100.0 * cache->hits / lookups : 0.0,
+        cache->millisSaved);
+}
@@ -0,0 +1,48 @@
+#ifndef PROGRAMCACHE_H
+#define PROGRAMCACHE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "GLES2/gl2.h"
+#include "GLES2/gl2ext.h"
+#include "EGL/egl.h"
+
+#include "global.h"
+#include "glresources.h"
+
+#define PROGRAM_CACHE_MAGIC                                   0x43505448 // "HTPC"
+#define PROGRAM_CACHE_VERSION                                          1
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t format;
+    uint32_t length;
+    uint64_t buildNanos;
+} ProgramCacheHeader;
+
+typedef struct {
+    char directory[256];
+    char supported;
+    PFNGLGETPROGRAMBINARYOESPROC getProgramBinary;
+    PFNGLPROGRAMBINARYOESPROC programBinary;
+    unsigned hits;
+    unsigned misses;
+    unsigned rejections;
+    double millisSaved;
+} ProgramCache;
+
+ProgramCache* program_cache_init(ProgramCache* c, const char* directory);
+
+// Returns 0, and caches nothing, if the program doesn't link.
+GLuint program_cache_build(ProgramCache* cache, const GLchar* vertexSource, const GLchar* fragmentSource, const GLchar* defines);
+void program_cache_report(ProgramCache* cache);
+
+#endif // PROGRAMCACHE_H
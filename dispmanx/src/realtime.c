@@ -0,0 +1,108 @@
+// For CPU_SET and sched_setaffinity.
+#define _GNU_SOURCE
+
+#include "realtime.h"
+
+static void prefault_stack() {
+    // Volatile, or the writes to a dead array would be optimised away.
+    volatile char stack[REALTIME_STACK_PREFAULT];
+    for (size_t i = 0; i < sizeof(stack); i += 4096) {
+        stack[i] = 0;
+    }
+}
+
+char realtime_parse(const char* cpus, int* renderCpu, int* simulationCpu) {
+    if (sscanf(cpus, "%d,%d", renderCpu, simulationCpu) == 2 && *renderCpu >= 0 && *simulationCpu >= 0) {
+        return 1;
+    }
+
+    fprintf(stderr, "RealTime: expected CPUs as RENDER,SIMULATION, e.g. 3,2; got %s.\n", cpus);
+
+    return 0;
+}
+
+RealTime* realtime_init(RealTime* r, int renderCpu, int simulationCpu) {
+    RealTime* realtime = r ? r : NEW(RealTime, 1);
+
+    memset(realtime, 0, sizeof(RealTime));
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    realtime->renderCpu = renderCpu >= 0 ? renderCpu : cpus - 1;
+    realtime->simulationCpu = simulationCpu >= 0 ? simulationCpu : cpus > 1 ? cpus - 2 : 0;
+    realtime->enabled = 1;
+
+    if (realtime->renderCpu == realtime->simulationCpu) {
+        fprintf(stderr, "RealTime: render and simulation threads share CPU %d\n", realtime->renderCpu);
+    }
+
+    return realtime;
+}
+
+void realtime_lock_memory(RealTime* realtime) {
+    if (!realtime->enabled) {
+        return;
+    }
+
+    // Freed memory stays in the heap, already locked and faulted in, and
+    // large blocks come from the heap rather than fresh mappings.
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+
+    // MCL_CURRENT faults in everything mapped so far; MCL_FUTURE does the
+    // same for every later mapping as it is made.
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) == -1) {
+        fprintf(stderr, "RealTime: unable to lock memory (%s); raise RLIMIT_MEMLOCK, e.g. ulimit -l unlimited\n", strerror(errno));
+    } else {
+        printf("RealTime: memory locked\n");
+    }
+}
+
+int realtime_job_cpu(const RealTime* realtime, unsigned worker) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    long available = realtime->simulationCpu != realtime->renderCpu && realtime->simulationCpu < cpus ? cpus - 1 : cpus;
+    long index = worker % available;
+
+    for (long i = 0; i < cpus; i++) {
+        int cpu = (realtime->renderCpu - i + cpus) % cpus;
+        if (cpu == realtime->simulationCpu && cpu != realtime->renderCpu) {
+            continue;
+        }
+        if (index-- == 0) {
+            return cpu;
+        }
+    }
+
+    return realtime->renderCpu;
+}
+
+void realtime_thread(RealTime* realtime, const char* name, int cpu, int priority) {
+    if (!realtime->enabled) {
+        return;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    char pinned = sched_setaffinity(0, sizeof(set), &set) == 0;
+    if (!pinned) {
+        fprintf(stderr, "RealTime: unable to pin the %s thread to CPU %d (%s)\n", name, cpu, strerror(errno));
+    }
+
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = priority;
+    char scheduled = sched_setscheduler(0, REALTIME_POLICY, &param) == 0;
+    if (!scheduled) {
+        fprintf(stderr, "RealTime: %s thread can't run real-time (%s); raise RLIMIT_RTPRIO or grant CAP_SYS_NICE\n", name, strerror(errno));
+    }
+
+    prefault_stack();
+
+    printf("RealTime: %s thread on ", name);
+    if (pinned) {
+        printf("CPU %d, ", cpu);
+    } else {
+        printf("any CPU, ");
+    }
+    printf(scheduled ? "%s priority %d\n" : "normal priority\n", REALTIME_POLICY == SCHED_FIFO ? "SCHED_FIFO" : "SCHED_RR", priority);
+}
@@ -0,0 +1,61 @@
+#ifndef REALTIME_H
+#define REALTIME_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <malloc.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+#include "global.h"
+
+// The simulation reads input and must not wait behind the renderer, so it
+// gets the higher priority; both stay below the kernel's own threads (99).
+#define REALTIME_POLICY                                       SCHED_FIFO
+#define REALTIME_RENDER_PRIORITY                                      50
+#define REALTIME_SIMULATION_PRIORITY                                  60
+
+// Job workers are the render thread's peers: it hands them parts of its
+// frame and sleeps until they are done.
+#define REALTIME_JOBS_PRIORITY                      REALTIME_RENDER_PRIORITY
+
+// Stack touched by each thread up front, so that deeper calls later don't
+// take page faults.
+#define REALTIME_STACK_PREFAULT                               (256 * 1024)
+
+// An opt-in low-jitter mode: each thread is pinned to its own CPU and run
+// under a real-time policy, and memory is locked and faulted in before the
+// loop starts, so that neither other processes nor paging stall a frame.
+// Whatever the system doesn't permit is reported and skipped; without
+// --realtime every call does nothing.
+typedef struct {
+    char enabled;
+    int renderCpu;
+    int simulationCpu;
+} RealTime;
+
+// Parses RENDER,SIMULATION CPU numbers; prints the format and returns 0
+// otherwise.
+char realtime_parse(const char* cpus, int* renderCpu, int* simulationCpu);
+
+// Picks the last two CPUs for any given as -1, where daemons are least
+// likely to be pinned.
+RealTime* realtime_init(RealTime* r, int renderCpu, int simulationCpu);
+
+// Locks the process's memory, current and future, and keeps malloc from
+// handing memory back to the kernel. Call once setup is done.
+void realtime_lock_memory(RealTime* realtime);
+
+// The CPU for job worker n, worker 0 being the render thread: the render
+// CPU, then the ones below it, wrapping round and skipping the
+// simulation's, and again from the start if there are more workers.
+int realtime_job_cpu(const RealTime* realtime, unsigned worker);
+
+// Pins the calling thread to cpu, gives it priority under REALTIME_POLICY
+// and faults in its stack.
+void realtime_thread(RealTime* realtime, const char* name, int cpu, int priority);
+
+#endif // REALTIME_H
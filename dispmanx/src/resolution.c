@@ -0,0 +1,205 @@
+#include "resolution.h"
+
+static const GLchar* upscale_vshader_source =
+    "attribute vec2 position;"
+
+    "uniform vec2 scale;"
+
+    "varying vec2 Texcoord;"
+
+    "void main() {"
+    " Texcoord = (position * 0.5 + 0.5) * scale;"
+    " gl_Position = vec4(position, 0.0, 1.0);"
+    "}";
+
+static const GLchar* upscale_fshader_source =
+    "precision mediump float;"
+
+    "varying vec2 Texcoord;"
+
+    "uniform sampler2D tex;"
+    "void main() {"
+    " gl_FragColor = texture2D(tex, Texcoord);"
+    "}";
+
+static void resolution_resize(Resolution* resolution, float scale) {
+    Window* window = resolution->window;
+
+    uint32_t width = (uint32_t)(window->width * scale) & ~7u;
+    uint32_t height = (uint32_t)(window->height * scale) & ~7u;
+
+    if (width != resolution->width || height != resolution->height) {
+        printf("Resolution: %ux%u -> %ux%u (%.0f%%), mean %.2f ms, budget %.2f ms\n",
+            resolution->width, resolution->height, width, height, 100 * scale,
+            resolution->averageMillis, resolution->budgetMillis);
+    }
+
+    resolution->scale = scale;
+    resolution->width = width;
+    resolution->height = height;
+    resolution->framesSinceChange = 0;
+}
+
+Resolution* resolution_init(Resolution* r, Window* window, ProgramCache* cache, float budgetMillis) {
+    Resolution* resolution = r ? r : NEW(Resolution, 1);
+
+    memset(resolution, 0, sizeof(Resolution));
+    resolution->window = window;
+    resolution->budgetMillis = budgetMillis;
+    resolution->averageMillis = budgetMillis;
+    resolution->scale = 1;
+    resolution->width = window->width;
+    resolution->height = window->height;
+    resolution->reportMinScale = 1;
+
+    // Target
+
+    gl_resources_gen(GL_RESOURCE_TEXTURE, &resolution->colorTexture, "upscale color");
+    glBindTexture(GL_TEXTURE_2D, resolution->colorTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, window->width, window->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    gl_resources_storage(GL_RESOURCE_TEXTURE, resolution->colorTexture, window->width * window->height * 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    gl_resources_gen(GL_RESOURCE_RENDERBUFFER, &resolution->depthRenderbuffer, "upscale depth");
+    glBindRenderbuffer(GL_RENDERBUFFER, resolution->depthRenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT16, window->width, window->height);
+    gl_resources_storage(GL_RESOURCE_RENDERBUFFER, resolution->depthRenderbuffer, window->width * window->height * 2);
+
+    gl_resources_gen(GL_RESOURCE_FRAMEBUFFER, &resolution->framebuffer, "upscale");
+    glBindFramebuffer(GL_FRAMEBUFFER, resolution->framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, resolution->colorTexture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, resolution->depthRenderbuffer);
+    assert(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, window->framebuffer);
+
+    glCheck();
+
+    // Upscale pass: one triangle that covers the screen, so it never reads
+    // more vertices than any other buffer left enabled holds.
+
+    resolution->program = gl_resources_track(GL_RESOURCE_PROGRAM, program_cache_build(cache, upscale_vshader_source, upscale_fshader_source, NULL), "upscale");
+
+    glUseProgram(resolution->program);
+    glUniform1i(glGetUniformLocation(resolution->program, "tex"), 0);
+    glUseProgram(0);
+
+    const GLfloat vertices[] = {
+        -1.0f, -1.0f,
+         3.0f, -1.0f,
+        -1.0f,  3.0f,
+    };
+
+    gl_resources_gen(GL_RESOURCE_BUFFER, &resolution->vbo, "upscale");
+    glBindBuffer(GL_ARRAY_BUFFER, resolution->vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    gl_resources_storage(GL_RESOURCE_BUFFER, resolution->vbo, sizeof(vertices));
+
+    glCheck();
+
+    printf("Resolution: dynamic, budget %.2f ms, native %ux%u\n", budgetMillis, window->width, window->height);
+
+    return resolution;
+}
+
+void resolution_destroy(Resolution* resolution) {
+    gl_resources_delete(GL_RESOURCE_BUFFER, &resolution->vbo);
+    gl_resources_delete(GL_RESOURCE_PROGRAM, &resolution->program);
+    gl_resources_delete(GL_RESOURCE_FRAMEBUFFER, &resolution->framebuffer);
+    gl_resources_delete(GL_RESOURCE_RENDERBUFFER, &resolution->depthRenderbuffer);
+    gl_resources_delete(GL_RESOURCE_TEXTURE, &resolution->colorTexture);
+}
+
+void resolution_begin(Resolution* resolution) {
+    glBindFramebuffer(GL_FRAMEBUFFER, resolution->framebuffer);
+    glViewport(0, 0, resolution->width, resolution->height);
+
+    // Only the part in use needs clearing.
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(0, 0, resolution->width, resolution->height);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glDisable(GL_SCISSOR_TEST);
+}
+
+void resolution_end(Resolution* resolution) {
+    Window* window = resolution->window;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, window->framebuffer);
+    glViewport(0, 0, window->width, window->height);
+
+    // The upscaled scene covers every pixel, so only depth needs clearing
+    // for the HUD drawn after it.
+    glClear(GL_DEPTH_BUFFER_BIT);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+
+    glUseProgram(resolution->program);
+    glUniform2f(glGetUniformLocation(resolution->program, "scale"),
+        (float)resolution->width / window->width, (float)resolution->height / window->height);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, resolution->colorTexture);
+
+    GLint positionAttribute = glGetAttribLocation(resolution->program, "position");
+
+    glBindBuffer(GL_ARRAY_BUFFER, resolution->vbo);
+    glEnableVertexAttribArray(positionAttribute);
+    glVertexAttribPointer(positionAttribute, 2, GL_FLOAT, 0, 2*sizeof(GLfloat), (const GLvoid*)0);
+
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    glEnable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+
+    glCheck();
+}
+
+void resolution_update(Resolution* resolution, float frameMillis) {
+    // Exponential moving average: smooths single-frame spikes out while still
+    // reacting within a few frames.
+    resolution->averageMillis = 0.9f * resolution->averageMillis + 0.1f * frameMillis;
+    resolution->framesSinceChange++;
+
+    resolution->reportFrames++;
+    resolution->reportMillis += frameMillis;
+    if (resolution->scale < resolution->reportMinScale) {
+        resolution->reportMinScale = resolution->scale;
+    }
+
+    if (resolution->reportFrames == RESOLUTION_REPORT_FRAMES) {
+        printf("Resolution: %ux%u, mean %.2f ms over %u frames, lowest scale %.0f%%\n",
+            resolution->width, resolution->height, resolution->reportMillis / resolution->reportFrames,
+            resolution->reportFrames, 100 * resolution->reportMinScale);
+
+        resolution->reportFrames = 0;
+        resolution->reportMillis = 0;
+        resolution->reportMinScale = resolution->scale;
+    }
+
+    // Let the average settle on the last change before judging it.
+    if (resolution->framesSinceChange < RESOLUTION_SETTLE_FRAMES) {
+        return;
+    }
+
+    float average = resolution->averageMillis;
+    float budget = resolution->budgetMillis;
+    float scale = resolution->scale;
+
+    if (average > budget * RESOLUTION_HIGH_WATER) {
+        // Fill cost goes with the pixel count, i.e. the square of the scale.
+        float target = scale * sqrtf(budget / average);
+        scale = fmaxf(target, scale - RESOLUTION_MAX_STEP);
+    } else if (average < budget * RESOLUTION_LOW_WATER) {
+        scale += RESOLUTION_UP_STEP;
+    } else {
+        return;
+    }
+
+    scale = fminf(1.0f, fmaxf(RESOLUTION_MIN_SCALE, scale));
+    if (scale != resolution->scale) {
+        resolution_resize(resolution, scale);
+    }
+}
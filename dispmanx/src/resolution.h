@@ -0,0 +1,64 @@
+#ifndef RESOLUTION_H
+#define RESOLUTION_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "GLES2/gl2.h"
+
+#include "global.h"
+#include "window.h"
+#include "programcache.h"
+#include "glresources.h"
+
+// Target band around the budget: above the high mark the scene is scaled
+// down, below the low mark it is scaled back up, and in between nothing
+// changes. The gap keeps the resolution from oscillating.
+#define RESOLUTION_HIGH_WATER                                       1.05f
+#define RESOLUTION_LOW_WATER                                        0.80f
+
+#define RESOLUTION_MIN_SCALE                                        0.50f
+#define RESOLUTION_MAX_STEP                                         0.10f
+#define RESOLUTION_UP_STEP                                          0.05f
+#define RESOLUTION_SETTLE_FRAMES                                      30
+#define RESOLUTION_REPORT_FRAMES                                     120
+
+// Renders the 3D scene into an offscreen target whose size follows a frame
+// time budget, then upscales it to the window. The target is allocated at
+// native size once; scaling only changes the viewport into it.
+typedef struct {
+    Window* window;
+
+    float budgetMillis;
+    float scale;
+    float averageMillis;
+    unsigned framesSinceChange;
+
+    uint32_t width;
+    uint32_t height;
+
+    GLuint framebuffer;
+    GLuint colorTexture;
+    GLuint depthRenderbuffer;
+    GLuint program;
+    GLuint vbo;
+
+    unsigned reportFrames;
+    double reportMillis;
+    float reportMinScale;
+} Resolution;
+
+Resolution* resolution_init(Resolution* r, Window* window, ProgramCache* cache, float budgetMillis);
+void resolution_destroy(Resolution* resolution);
+
+// Bracket the scene: begin binds and clears the scaled target, end upscales
+// it into the window's framebuffer.
+void resolution_begin(Resolution* resolution);
+void resolution_end(Resolution* resolution);
+
+// Feeds the time the last frame took to render and picks the next scale.
+void resolution_update(Resolution* resolution, float frameMillis);
+
+#endif // RESOLUTION_H
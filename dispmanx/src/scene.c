@@ -0,0 +1,38 @@
+#include "scene.h"
+
+SceneBuffer* scene_buffer_init(SceneBuffer* b) {
+    SceneBuffer* buffer = b ? b : NEW(SceneBuffer, 1);
+
+    memset(buffer, 0, sizeof(SceneBuffer));
+    buffer->back = 0;
+    buffer->middle = 1;
+    buffer->front = 2;
+
+    return buffer;
+}
+
+Scene* scene_buffer_back(SceneBuffer* buffer) {
+    return &buffer->slots[buffer->back];
+}
+
+void scene_buffer_publish(SceneBuffer* buffer) {
+    // Release makes the scene written to the back slot visible to the
+    // reader that acquires the slot.
+    int middle = __atomic_exchange_n(&buffer->middle, buffer->back | SCENE_BUFFER_FRESH, __ATOMIC_ACQ_REL);
+    buffer->back = middle & SCENE_BUFFER_INDEX;
+}
+
+char scene_buffer_update(SceneBuffer* buffer) {
+    if (!(__atomic_load_n(&buffer->middle, __ATOMIC_RELAXED) & SCENE_BUFFER_FRESH)) {
+        return 0;
+    }
+
+    int middle = __atomic_exchange_n(&buffer->middle, buffer->front, __ATOMIC_ACQ_REL);
+    buffer->front = middle & SCENE_BUFFER_INDEX;
+
+    return 1;
+}
+
+const Scene* scene_buffer_front(SceneBuffer* buffer) {
+    return &buffer->slots[buffer->front];
+}
@@ -0,0 +1,57 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include "GLES2/gl2.h"
+
+#include "global.h"
+
+// Set in SceneBuffer.middle when it holds a scene the reader hasn't taken.
+#define SCENE_BUFFER_FRESH                                          0x4
+#define SCENE_BUFFER_INDEX                                          0x3
+
+// What the simulation hands the renderer after each tick.
+typedef struct {
+    uint32_t sequence;              // ticks published before this one, plus 1
+
+    // The rotation after the latest step and the one before, how far the
+    // clock was into the next step, and when.
+    GLfloat rotation[3];
+    GLfloat previousRotation[3];
+    float alpha;
+    struct timespec time;
+
+    // Times of the newest input events the tick read, on CLOCK_MONOTONIC.
+    struct timeval mouseEvent;
+    struct timeval keyboardEvent;
+} Scene;
+
+// Lock-free single-producer, single-consumer triple buffer of scenes. The
+// writer fills the back slot and publishes it by swapping it with the
+// middle one; the reader takes the middle slot, if it is newer than what it
+// has, by swapping it with the front one. Neither side ever waits, and a
+// slow reader skips the scenes it had no time for.
+typedef struct {
+    Scene slots[3];
+    int back;
+    int middle;
+    int front;
+} SceneBuffer;
+
+SceneBuffer* scene_buffer_init(SceneBuffer* b);
+
+// Writer side.
+Scene* scene_buffer_back(SceneBuffer* buffer);
+void scene_buffer_publish(SceneBuffer* buffer);
+
+// Reader side: takes the newest published scene and returns 1, or returns
+// 0 if nothing was published since the last call.
+char scene_buffer_update(SceneBuffer* buffer);
+const Scene* scene_buffer_front(SceneBuffer* buffer);
+
+#endif // SCENE_H
@@ -0,0 +1,35 @@
+#include "simclock.h"
+
+SimClock* sim_clock_init(SimClock* c, double step, unsigned maxSteps) {
+    SimClock* clock = c ? c : NEW(SimClock, 1);
+
+    memset(clock, 0, sizeof(SimClock));
+    clock->step = step;
+    clock->maxSteps = maxSteps;
+
+    return clock;
+}
+
+void sim_clock_reset(SimClock* clock) {
+    clock->accumulator = 0;
+}
+
+unsigned sim_clock_advance(SimClock* clock, double seconds) {
+    clock->accumulator += seconds;
+
+    double limit = clock->maxSteps * clock->step;
+    if (clock->accumulator > limit) {
+        clock->droppedSeconds += clock->accumulator - limit;
+        clock->accumulator = limit;
+    }
+
+    unsigned steps = clock->accumulator / clock->step;
+    clock->accumulator -= steps * clock->step;
+    clock->steps += steps;
+
+    return steps;
+}
+
+float sim_clock_alpha(const SimClock* clock) {
+    return clock->accumulator / clock->step;
+}
@@ -0,0 +1,42 @@
+#ifndef SIMCLOCK_H
+#define SIMCLOCK_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "global.h"
+
+#define SIM_CLOCK_STEP_SECONDS                               (1.0 / 60)
+
+// Frames slower than this many steps only catch up this far; the rest of
+// the time is dropped, so that a stall doesn't turn into a burst of
+// updates that makes the next frame slower still.
+#define SIM_CLOCK_MAX_STEPS                                            5
+
+// Runs the simulation in fixed steps, whatever the frame rate: each frame
+// adds the time it took, and the simulation is advanced a whole number of
+// steps. The time left over becomes the fraction of a step to interpolate
+// the drawn state by.
+typedef struct {
+    double step;
+    unsigned maxSteps;
+    double accumulator;
+
+    uint64_t steps;
+    double droppedSeconds;
+} SimClock;
+
+SimClock* sim_clock_init(SimClock* c, double step, unsigned maxSteps);
+
+// Forgets the time accumulated, e.g. when the simulation is resumed.
+void sim_clock_reset(SimClock* clock);
+
+// Adds the seconds elapsed since the last frame and returns how many steps
+// to run.
+unsigned sim_clock_advance(SimClock* clock, double seconds);
+
+// How far the next step has progressed, from 0 to 1.
+float sim_clock_alpha(const SimClock* clock);
+
+#endif // SIMCLOCK_H
@@ -0,0 +1,38 @@
+#include "startup.h"
+
+static struct timespec startTime;
+static StartupMark marks[STARTUP_MAX_MARKS];
+static int markCount;
+
+static double millis_since(struct timespec* from, struct timespec* to) {
+    return (to->tv_sec - from->tv_sec) * 1000.0 + (to->tv_nsec - from->tv_nsec) / 1e6;
+}
+
+void startup_begin() {
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+    markCount = 0;
+}
+
+void startup_mark(const char* phase) {
+    // Worker threads may mark their phases concurrently with the main thread.
+    int i = __atomic_fetch_add(&markCount, 1, __ATOMIC_RELAXED);
+    if (i >= STARTUP_MAX_MARKS) {
+        return;
+    }
+
+    marks[i].phase = phase;
+    clock_gettime(CLOCK_MONOTONIC, &marks[i].time);
+}
+
+void startup_report() {
+    int count = markCount < STARTUP_MAX_MARKS ? markCount : STARTUP_MAX_MARKS;
+    struct timespec* previous = &startTime;
+
+    printf("Startup:\n");
+    for (int i = 0; i < count; i++) {
+        printf("  %-24s %8.2f ms %8.2f ms\n", marks[i].phase,
+            millis_since(previous, &marks[i].time),
+            millis_since(&startTime, &marks[i].time));
+        previous = &marks[i].time;
+    }
+}
@@ -0,0 +1,18 @@
+#ifndef STARTUP_H
+#define STARTUP_H
+
+#include <stdio.h>
+#include <time.h>
+
+#define STARTUP_MAX_MARKS                                             32
+
+typedef struct {
+    const char* phase;
+    struct timespec time;
+} StartupMark;
+
+void startup_begin();
+void startup_mark(const char* phase);
+void startup_report();
+
+#endif // STARTUP_H
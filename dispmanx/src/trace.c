@@ -0,0 +1,145 @@
+#include "trace.h"
+
+#ifdef HAVE_TRACE
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+static const char* tracePath;
+static TraceBuffer* buffers;
+static __thread TraceBuffer* threadBuffer;
+static volatile sig_atomic_t exportRequested;
+
+static uint64_t now() {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec * 1000000000ull + time.tv_nsec;
+}
+
+static void request_export(int signum) {
+    (void)signum;
+
+    // Writing the file isn't async-signal-safe; the main loop does it.
+    exportRequested = 1;
+}
+
+static TraceBuffer* thread_buffer() {
+    if (threadBuffer) {
+        return threadBuffer;
+    }
+
+    TraceBuffer* buffer = calloc(1, sizeof(TraceBuffer));
+    if (!buffer) {
+        return NULL;
+    }
+    buffer->tid = syscall(SYS_gettid);
+
+    // Push onto the list of buffers; threads may start concurrently.
+    buffer->next = __atomic_load_n(&buffers, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&buffers, &buffer->next, buffer, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+    }
+
+    threadBuffer = buffer;
+    return buffer;
+}
+
+void trace_init(const char* path) {
+    const char* environment = getenv("TRACE_FILE");
+    tracePath = environment ? environment : path;
+
+    signal(SIGUSR1, request_export);
+
+    trace_thread_name("main");
+    printf("Trace: writing %s on exit or SIGUSR1\n", tracePath);
+}
+
+void trace_thread_name(const char* name) {
+    TraceBuffer* buffer = thread_buffer();
+    if (buffer) {
+        buffer->threadName = name;
+    }
+}
+
+TraceScope trace_scope_begin(const char* name) {
+    TraceScope scope = { name, now() };
+    return scope;
+}
+
+void trace_scope_end(TraceScope* scope) {
+    uint64_t end = now();
+
+    TraceBuffer* buffer = thread_buffer();
+    if (!buffer) {
+        return;
+    }
+
+    // Only this thread writes to the buffer; once full, new spans are dropped
+    // so what was exported stays consistent.
+    unsigned count = buffer->count;
+    if (count == TRACE_EVENTS_PER_THREAD) {
+        buffer->dropped++;
+        return;
+    }
+
+    TraceEvent* event = &buffer->events[count];
+    event->name = scope->name;
+    event->begin = scope->begin;
+    event->end = end;
+
+    __atomic_store_n(&buffer->count, count + 1, __ATOMIC_RELEASE);
+}
+
+void trace_poll() {
+    if (exportRequested) {
+        exportRequested = 0;
+        trace_export();
+    }
+}
+
+void trace_export() {
+    FILE* file = fopen(tracePath, "w");
+    if (!file) {
+        fprintf(stderr, "Trace: couldn't write %s\n", tracePath);
+        return;
+    }
+
+    int pid = getpid();
+    unsigned total = 0;
+    char first = 1;
+
+    fprintf(file, "{\"traceEvents\":[\n");
+
+    for (TraceBuffer* buffer = __atomic_load_n(&buffers, __ATOMIC_ACQUIRE); buffer; buffer = buffer->next) {
+        unsigned count = __atomic_load_n(&buffer->count, __ATOMIC_ACQUIRE);
+
+        if (buffer->threadName) {
+            fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                first ? "" : ",\n", pid, buffer->tid, buffer->threadName);
+            first = 0;
+        }
+
+        for (unsigned i = 0; i < count; i++) {
+            TraceEvent* event = &buffer->events[i];
+
+            fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d}",
+                first ? "" : ",\n", event->name, event->begin / 1e3, (event->end - event->begin) / 1e3, pid, buffer->tid);
+            first = 0;
+        }
+
+        total += count;
+        if (buffer->dropped) {
+            fprintf(stderr, "Trace: thread %d dropped %u events\n", buffer->tid, buffer->dropped);
+        }
+    }
+
+    fprintf(file, "\n]}\n");
+    fclose(file);
+
+    printf("Trace: %u events written to %s\n", total, tracePath);
+}
+
+#endif // HAVE_TRACE
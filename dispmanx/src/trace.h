@@ -0,0 +1,60 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+// Scoped trace spans, exported as Chrome trace-event JSON that loads in
+// chrome://tracing and ui.perfetto.dev. Built with `make TRACE=1`; otherwise
+// every macro below expands to nothing and the spans cost nothing.
+//
+//   TRACE_SCOPE("draw");     // span from here to the end of the block
+
+#ifdef HAVE_TRACE
+
+#include <stdint.h>
+
+#define TRACE_EVENTS_PER_THREAD                                    65536
+
+typedef struct {
+    const char* name;
+    uint64_t begin;
+    uint64_t end;
+} TraceEvent;
+
+// Each thread records into its own buffer, so recording takes no lock; the
+// exporter only reads the events the owner has published through count.
+typedef struct TraceBuffer {
+    struct TraceBuffer* next;
+    const char* threadName;
+    int tid;
+    unsigned count;
+    unsigned dropped;
+    TraceEvent events[TRACE_EVENTS_PER_THREAD];
+} TraceBuffer;
+
+typedef struct {
+    const char* name;
+    uint64_t begin;
+} TraceScope;
+
+void trace_init(const char* path);
+void trace_thread_name(const char* name);
+TraceScope trace_scope_begin(const char* name);
+void trace_scope_end(TraceScope* scope);
+void trace_poll();
+void trace_export();
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) \
+    TraceScope TRACE_CONCAT(traceScope, __LINE__) __attribute__((cleanup(trace_scope_end))) = trace_scope_begin(name)
+
+#else
+
+#define trace_init(path)
+#define trace_thread_name(name)
+#define trace_poll()
+#define trace_export()
+#define TRACE_SCOPE(name)
+
+#endif // HAVE_TRACE
+
+#endif // TRACE_H
@@ -1,103 +1,200 @@
 #include "window.h"
 
-Window* window_init(Window* w) {
-   Window* window = w ? w : NEW(Window, 1);
+static const WindowBackend* backends[] = {
+#ifdef HAVE_DISPMANX
+   &windowDispmanx,
+#endif
+#ifdef HAVE_KMS
+   &windowKms,
+#endif
+   &windowSurfaceless,
+   NULL
+};
+
+const WindowBackend* window_backend(const char* name) {
+   for (unsigned i = 0; backends[i]; i++) {
+      if (!name || !strcmp(backends[i]->name, name)) {
+         return backends[i];
+      }
+   }
+
+   fprintf(stderr, "Window: no backend named %s. Available:", name);
+   for (unsigned i = 0; backends[i]; i++) {
+      fprintf(stderr, " %s", backends[i]->name);
+   }
+   fprintf(stderr, "\n");
+
+   return NULL;
+}
+
+static void set_attribute(EGLint* attribute_list, EGLint attribute, EGLint value) {
+   for (EGLint* a = attribute_list; *a != EGL_NONE; a += 2) {
+      if (*a == attribute) {
+         a[1] = value;
+         return;
+      }
+   }
+}
+
+static EGLConfig match_visual(Window* window, EGLConfig* configs, EGLint num_config, EGLint visualId) {
+   if (!visualId) {
+      return configs[0];
+   }
+
+   // GBM scanout buffers have a fixed format, so the config's native visual
+   // has to match it exactly.
+   for (EGLint i = 0; i < num_config; i++) {
+      EGLint id;
+      if (eglGetConfigAttrib(window->display, configs[i], EGL_NATIVE_VISUAL_ID, &id) && id == visualId) {
+         return configs[i];
+      }
+   }
+
+   fprintf(stderr, "Window: no config matches visual 0x%x.\n", visualId);
+
+   return configs[0];
+}
+
+// A debug context, where EGL can make one, has the driver report more
+// through KHR_debug; drivers that refuse it for ES get a plain context.
+static EGLContext create_context(Window* window, EGLConfig config, EGLint glesVersion) {
+   const EGLint context_attributes[] =
+   {
+      EGL_CONTEXT_CLIENT_VERSION, glesVersion,
+      EGL_NONE
+   };
 
-   // Initialize OpenGL
+#ifdef EGL_KHR_create_context
+   const EGLint debug_context_attributes[] =
+   {
+      EGL_CONTEXT_CLIENT_VERSION, glesVersion,
+      EGL_CONTEXT_FLAGS_KHR, EGL_CONTEXT_OPENGL_DEBUG_BIT_KHR,
+      EGL_NONE
+   };
 
-   int32_t success = 0;
-   EGLBoolean result;
-   EGLint num_config;
+   const char* extensions = eglQueryString(window->display, EGL_EXTENSIONS);
+   if (gl_debug_wants_context() && extensions && strstr(extensions, "EGL_KHR_create_context")) {
+      EGLContext context = eglCreateContext(window->display, config, EGL_NO_CONTEXT, debug_context_attributes);
+      if (context != EGL_NO_CONTEXT) {
+         return context;
+      }
+   }
+#endif
 
-   static EGL_DISPMANX_WINDOW_T nativewindow;
+   return eglCreateContext(window->display, config, EGL_NO_CONTEXT, context_attributes);
+}
 
-   DISPMANX_ELEMENT_HANDLE_T dispman_element;
-   DISPMANX_DISPLAY_HANDLE_T dispman_display;
-   DISPMANX_UPDATE_HANDLE_T dispman_update;
-   VC_RECT_T dst_rect;
-   VC_RECT_T src_rect;
+EGLConfig window_choose_config(Window* window, EGLint surfaceType, EGLint visualId) {
+   EGLBoolean result;
+   EGLint num_config;
 
-   static const EGLint attribute_list[] =
+   EGLint attribute_list[] =
    {
       EGL_RED_SIZE, 8,
       EGL_GREEN_SIZE, 8,
       EGL_BLUE_SIZE, 8,
-      EGL_ALPHA_SIZE, 8,
-      // EGL_SAMPLES, 8,
-      EGL_SURFACE_TYPE, EGL_WINDOW_BIT,
+      EGL_ALPHA_SIZE, visualId ? 0 : 8,
+      EGL_SAMPLE_BUFFERS, window->samples ? 1 : 0,
+      EGL_SAMPLES, window->samples,
+      EGL_SURFACE_TYPE, surfaceType,
+      EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
       EGL_NONE
    };
-   
-   static const EGLint context_attributes[] = 
-   {
-      EGL_CONTEXT_CLIENT_VERSION, 2,
-      EGL_NONE
-   };
-   EGLConfig config;
 
-   bcm_host_init();
+   EGLConfig configs[64];
+   result = eglChooseConfig(window->display, attribute_list, configs, 64, &num_config);
+   assert(EGL_FALSE != result);
+
+   if (num_config == 0 && window->samples) {
+      fprintf(stderr, "Window: no %dx multisampled config, falling back to none.\n", window->samples);
+      set_attribute(attribute_list, EGL_SAMPLE_BUFFERS, 0);
+      set_attribute(attribute_list, EGL_SAMPLES, 0);
+      result = eglChooseConfig(window->display, attribute_list, configs, 64, &num_config);
+      assert(EGL_FALSE != result);
+   }
+   assert(num_config > 0);
+
+   EGLConfig config = match_visual(window, configs, num_config, visualId);
+
+   // A config may have more samples than asked for, or none after the
+   // fallback; what it has is what the frame gets.
+   if (!eglGetConfigAttrib(window->display, config, EGL_SAMPLES, &window->samples)) {
+      window->samples = 0;
+   }
+
+   return config;
+}
+
+Window* window_init(Window* w, const WindowBackend* backend, int maxGlesVersion, EGLint samples) {
+   Window* window = w ? w : NEW(Window, 1);
+
+   memset(window, 0, sizeof(Window));
+   window->backend = backend;
+   window->surface = EGL_NO_SURFACE;
+   window->samples = samples;
 
-   // get an EGL display connection
-   window->display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+   // Initialize OpenGL
+
+   EGLBoolean result;
+
+   EGLConfig config;
+
+   // open the platform and get an EGL display connection for it
+   if (!backend->open(window)) {
+      fprintf(stderr, "Window: unable to open %s.\n", backend->name);
+      backend->close(window);
+      if (!w) {
+         free(window);
+      }
+      return NULL;
+   }
    assert(window->display!=EGL_NO_DISPLAY);
-   glCheck();
 
    // initialize the EGL display connection
    result = eglInitialize(window->display, NULL, NULL);
    assert(EGL_FALSE != result);
-   glCheck();
 
    // get an appropriate EGL frame buffer configuration
-   result = eglChooseConfig(window->display, attribute_list, &config, 1, &num_config);
-   assert(EGL_FALSE != result);
-   glCheck();
+   config = backend->choose_config(window);
 
    // get an appropriate EGL frame buffer configuration
    result = eglBindAPI(EGL_OPENGL_ES_API);
    assert(EGL_FALSE != result);
-   glCheck();
 
-   // create an EGL rendering context
-   window->context = eglCreateContext(window->display, config, EGL_NO_CONTEXT, context_attributes);
+   // create an EGL rendering context, falling back to ES 2.0 if the driver
+   // has no ES 3.0 support
+   window->context = EGL_NO_CONTEXT;
+#ifdef HAVE_GLES3
+   if (maxGlesVersion >= 3) {
+      window->context = create_context(window, config, 3);
+      window->glesVersion = 3;
+   }
+#endif
+   if (window->context == EGL_NO_CONTEXT) {
+      window->context = create_context(window, config, 2);
+      window->glesVersion = 2;
+   }
    assert(window->context!=EGL_NO_CONTEXT);
-   glCheck();
 
-   // create an EGL window surface
-   success = graphics_get_display_size(0 /* LCD */, &window->width, &window->height);
-   assert( success >= 0 );
-
-   dst_rect.x = 0;
-   dst_rect.y = 0;
-   dst_rect.width = window->width;
-   dst_rect.height = window->height;
-      
-   src_rect.x = 0;
-   src_rect.y = 0;
-   src_rect.width = window->width << 16;
-   src_rect.height = window->height << 16;        
-
-   dispman_display = vc_dispmanx_display_open( 0 /* LCD */);
-   dispman_update = vc_dispmanx_update_start( 0 );
-         
-   dispman_element = vc_dispmanx_element_add ( dispman_update, dispman_display,
-      0/*layer*/, &dst_rect, 0/*src*/,
-      &src_rect, DISPMANX_PROTECTION_NONE, 0 /*alpha*/, 0/*clamp*/, 0/*transform*/);
-      
-   nativewindow.element = dispman_element;
-   nativewindow.width = window->width;
-   nativewindow.height = window->height;
-   vc_dispmanx_update_submit_sync( dispman_update );
-   glCheck();
+   // create the surface and connect the context to it; surfaceless backends
+   // make the context current on its own first and render to an FBO
+   if (!backend->create_surface(window, config)) {
+      fprintf(stderr, "Window: unable to create a %s surface.\n", backend->name);
+      window_destroy(window);
+      if (!w) {
+         free(window);
+      }
+      return NULL;
+   }
 
-   window->surface = eglCreateWindowSurface( window->display, config, &nativewindow, NULL );
-   assert(window->surface != EGL_NO_SURFACE);
-   glCheck();
-
-   // connect the context to the surface
    result = eglMakeCurrent(window->display, window->surface, window->surface, window->context);
    assert(EGL_FALSE != result);
    glCheck();
 
+   printf("Window: %s, %ux%u, %dx MSAA, OpenGL ES %d context (%s)\n", backend->name, window->width, window->height, window->samples, window->glesVersion, glGetString(GL_VERSION));
+
+   glViewport(0, 0, window->width, window->height);
+
    glEnable(GL_BLEND);
    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
    glEnable(GL_DEPTH_TEST);
@@ -110,4 +207,33 @@ Window* window_init(Window* w) {
    glCheck();
 
    return window;
-}
\ No newline at end of file
+}
+
+void window_swap(Window* window) {
+   window->backend->swap(window);
+}
+
+void window_destroy(Window* window) {
+   if (window->display == EGL_NO_DISPLAY) {
+      return;
+   }
+
+   if (window->backend->destroy_surface && window->context != EGL_NO_CONTEXT) {
+      window->backend->destroy_surface(window);
+   }
+
+   eglMakeCurrent(window->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+   if (window->surface != EGL_NO_SURFACE) {
+      eglDestroySurface(window->display, window->surface);
+   }
+   if (window->context != EGL_NO_CONTEXT) {
+      eglDestroyContext(window->display, window->context);
+   }
+
+   eglTerminate(window->display);
+
+   window->backend->close(window);
+
+   window->display = EGL_NO_DISPLAY;
+}
@@ -1,24 +1,87 @@
 #ifndef WINDOW_H
 #define WINDOW_H
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
 #include <assert.h>
 
-#include "bcm_host.h"
-
 #include "GLES2/gl2.h"
+#ifdef HAVE_GLES3
+#include "GLES3/gl3.h"
+#endif
 #include "EGL/egl.h"
 #include "EGL/eglext.h"
 
 #include "global.h"
+#include "glresources.h"
+#include "gldebug.h"
+
+typedef struct Window Window;
 
+// A platform that can show (or just host) the EGL surface. window_init does
+// the EGL work common to every platform and calls into the backend for the
+// platform-specific parts.
 typedef struct {
-   EGLDisplay display;
-   EGLContext context;
-   EGLSurface surface;
-   uint32_t width;
-   uint32_t height;
-} Window;
-
-Window* window_init(Window* w);
+    const char* name;
+
+    // Opens the platform and sets window->display, width and height.
+    char (*open)(Window* window);
+
+    // Picks a config compatible with the platform's surfaces.
+    EGLConfig (*choose_config)(Window* window);
+
+    // Creates window->surface, or leaves it EGL_NO_SURFACE for backends that
+    // render to an FBO. Called with the context current when surfaceless.
+    char (*create_surface)(Window* window, EGLConfig config);
+
+    // Deletes any GL objects create_surface made, with the context still
+    // current. May be NULL.
+    void (*destroy_surface)(Window* window);
+
+    // Presents the frame just drawn.
+    void (*swap)(Window* window);
+
+    void (*close)(Window* window);
+} WindowBackend;
+
+struct Window {
+    const WindowBackend* backend;
+    void* platform;
+
+    EGLDisplay display;
+    EGLContext context;
+    EGLSurface surface;
+    GLuint framebuffer;     // what to bind to draw to the window; 0 unless the backend renders to an FBO
+    uint32_t width;
+    uint32_t height;
+    int glesVersion;
+    EGLint samples;
+    float refreshHz;        // of the display mode; 0 if the backend can't tell
+};
+
+#ifdef HAVE_DISPMANX
+extern const WindowBackend windowDispmanx;
+#endif
+#ifdef HAVE_KMS
+extern const WindowBackend windowKms;
+#endif
+extern const WindowBackend windowSurfaceless;
+
+// Looks a backend up by name; NULL picks the first one this build has.
+const WindowBackend* window_backend(const char* name);
+
+// Creates a context of the highest ES version up to maxGlesVersion that the
+// driver offers. ES 3.0 is only attempted in HAVE_GLES3 builds. samples asks
+// for a multisampled config, falling back to none if there is no such config.
+Window* window_init(Window* w, const WindowBackend* backend, int maxGlesVersion, EGLint samples);
+void window_swap(Window* window);
+void window_destroy(Window* window);
+
+// Shared by the backends: the first config with the given surface type,
+// window->samples and, if visualId is non-zero, that native visual. Sets
+// window->samples to the samples the config actually has.
+EGLConfig window_choose_config(Window* window, EGLint surfaceType, EGLint visualId);
 
 #endif // WINDOW_H
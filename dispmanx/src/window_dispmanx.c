@@ -0,0 +1,99 @@
+#include "window.h"
+
+#include "bcm_host.h"
+
+// Legacy Raspberry Pi firmware: a full-screen dispmanx element on the LCD.
+
+typedef struct {
+   EGL_DISPMANX_WINDOW_T nativewindow;
+   DISPMANX_DISPLAY_HANDLE_T display;
+   DISPMANX_ELEMENT_HANDLE_T element;
+} DispmanxPlatform;
+
+static char dispmanx_open(Window* window) {
+   int32_t success = 0;
+
+   bcm_host_init();
+
+   // get an EGL display connection
+   window->display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+   if (window->display == EGL_NO_DISPLAY) {
+      return 0;
+   }
+
+   success = graphics_get_display_size(0 /* LCD */, &window->width, &window->height);
+   assert( success >= 0 );
+
+   return 1;
+}
+
+static EGLConfig dispmanx_choose_config(Window* window) {
+   return window_choose_config(window, EGL_WINDOW_BIT, 0);
+}
+
+static char dispmanx_create_surface(Window* window, EGLConfig config) {
+   DispmanxPlatform* platform = NEW(DispmanxPlatform, 1);
+   window->platform = platform;
+
+   DISPMANX_UPDATE_HANDLE_T dispman_update;
+   VC_RECT_T dst_rect;
+   VC_RECT_T src_rect;
+
+   // create an EGL window surface
+   dst_rect.x = 0;
+   dst_rect.y = 0;
+   dst_rect.width = window->width;
+   dst_rect.height = window->height;
+      
+   src_rect.x = 0;
+   src_rect.y = 0;
+   src_rect.width = window->width << 16;
+   src_rect.height = window->height << 16;        
+
+   platform->display = vc_dispmanx_display_open( 0 /* LCD */);
+   dispman_update = vc_dispmanx_update_start( 0 );
+         
+   platform->element = vc_dispmanx_element_add ( dispman_update, platform->display,
+      0/*layer*/, &dst_rect, 0/*src*/,
+      &src_rect, DISPMANX_PROTECTION_NONE, 0 /*alpha*/, 0/*clamp*/, 0/*transform*/);
+      
+   platform->nativewindow.element = platform->element;
+   platform->nativewindow.width = window->width;
+   platform->nativewindow.height = window->height;
+   vc_dispmanx_update_submit_sync( dispman_update );
+
+   window->surface = eglCreateWindowSurface( window->display, config, &platform->nativewindow, NULL );
+
+   return window->surface != EGL_NO_SURFACE;
+}
+
+static void dispmanx_swap(Window* window) {
+   eglSwapBuffers(window->display, window->surface);
+}
+
+static void dispmanx_close(Window* window) {
+   DispmanxPlatform* platform = window->platform;
+   if (!platform) {
+      return;
+   }
+
+   DISPMANX_UPDATE_HANDLE_T dispman_update = vc_dispmanx_update_start( 0 );
+   vc_dispmanx_element_remove(dispman_update, platform->element);
+   vc_dispmanx_update_submit_sync( dispman_update );
+   vc_dispmanx_display_close(platform->display);
+
+   free(platform);
+   window->platform = NULL;
+
+   bcm_host_deinit();
+}
+
+const WindowBackend windowDispmanx = {
+   "dispmanx",
+   dispmanx_open,
+   dispmanx_choose_config,
+   dispmanx_create_surface,
+   NULL,
+   dispmanx_swap,
+   dispmanx_close
+};
@@ -0,0 +1,267 @@
+#include "window.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+#include <gbm.h>
+
+// DRM/KMS with GBM buffers: the first connected connector in its preferred
+// mode, presented with page flips. Works on the Pi's KMS driver, desktop GPUs
+// and the vkms virtual display.
+
+typedef struct {
+   int fd;
+   drmModeModeInfo mode;
+   uint32_t connectorId;
+   uint32_t crtcId;
+   drmModeCrtc* savedCrtc;
+
+   struct gbm_device* device;
+   struct gbm_surface* surface;
+   struct gbm_bo* bo;
+
+   char flipPending;
+   unsigned flips;
+} KmsPlatform;
+
+static const char* kms_device() {
+   const char* device = getenv("KMS_DEVICE");
+   return device ? device : "/dev/dri/card0";
+}
+
+static char kms_find_display(KmsPlatform* platform) {
+   drmModeRes* resources = drmModeGetResources(platform->fd);
+   if (!resources) {
+      return 0;
+   }
+
+   drmModeConnector* connector = NULL;
+   for (int i = 0; i < resources->count_connectors; i++) {
+      connector = drmModeGetConnector(platform->fd, resources->connectors[i]);
+      if (!connector) {
+         continue;
+      }
+
+      // Without an encoder there is no way to a CRTC.
+      if (connector->connection == DRM_MODE_CONNECTED && connector->count_modes > 0 &&
+          (connector->encoder_id || connector->count_encoders > 0)) {
+         break;
+      }
+      drmModeFreeConnector(connector);
+      connector = NULL;
+   }
+
+   if (!connector) {
+      drmModeFreeResources(resources);
+      return 0;
+   }
+
+   // The preferred mode, or the first listed if none is marked
+   platform->mode = connector->modes[0];
+   for (int i = 0; i < connector->count_modes; i++) {
+      if (connector->modes[i].type & DRM_MODE_TYPE_PREFERRED) {
+         platform->mode = connector->modes[i];
+         break;
+      }
+   }
+   platform->connectorId = connector->connector_id;
+
+   // Keep the CRTC the connector is already driven by; otherwise take the
+   // first one its encoder can use.
+   drmModeEncoder* encoder = drmModeGetEncoder(platform->fd, connector->encoder_id ? connector->encoder_id : connector->encoders[0]);
+   if (encoder && encoder->crtc_id) {
+      platform->crtcId = encoder->crtc_id;
+   } else if (encoder) {
+      for (int i = 0; i < resources->count_crtcs; i++) {
+         if (encoder->possible_crtcs & (1 << i)) {
+            platform->crtcId = resources->crtcs[i];
+            break;
+         }
+      }
+   }
+
+   drmModeFreeEncoder(encoder);
+   drmModeFreeConnector(connector);
+   drmModeFreeResources(resources);
+
+   return platform->crtcId != 0;
+}
+
+static char kms_open(Window* window) {
+   KmsPlatform* platform = NEW(KmsPlatform, 1);
+   memset(platform, 0, sizeof(KmsPlatform));
+   window->platform = platform;
+
+   platform->fd = open(kms_device(), O_RDWR | O_CLOEXEC);
+   if (platform->fd == -1) {
+      perror("Window: unable to open DRM device.");
+      return 0;
+   }
+
+   if (!kms_find_display(platform)) {
+      fprintf(stderr, "Window: no connected display on %s.\n", kms_device());
+      return 0;
+   }
+
+   platform->savedCrtc = drmModeGetCrtc(platform->fd, platform->crtcId);
+
+   window->refreshHz = platform->mode.vrefresh;
+   window->width = platform->mode.hdisplay;
+   window->height = platform->mode.vdisplay;
+
+   platform->device = gbm_create_device(platform->fd);
+   if (!platform->device) {
+      return 0;
+   }
+
+   PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+   window->display = getPlatformDisplay
+      ? getPlatformDisplay(EGL_PLATFORM_GBM_KHR, platform->device, NULL)
+      : eglGetDisplay((EGLNativeDisplayType)platform->device);
+
+   return window->display != EGL_NO_DISPLAY;
+}
+
+static EGLConfig kms_choose_config(Window* window) {
+   return window_choose_config(window, EGL_WINDOW_BIT, GBM_FORMAT_XRGB8888);
+}
+
+static char kms_create_surface(Window* window, EGLConfig config) {
+   KmsPlatform* platform = window->platform;
+
+   platform->surface = gbm_surface_create(platform->device, window->width, window->height, GBM_FORMAT_XRGB8888, GBM_BO_USE_SCANOUT | GBM_BO_USE_RENDERING);
+   if (!platform->surface) {
+      return 0;
+   }
+
+   window->surface = eglCreateWindowSurface(window->display, config, (EGLNativeWindowType)platform->surface, NULL);
+
+   return window->surface != EGL_NO_SURFACE;
+}
+
+static void kms_destroy_framebuffer(struct gbm_bo* bo, void* data) {
+   int fd = gbm_device_get_fd(gbm_bo_get_device(bo));
+   uint32_t fb = (uint32_t)(uintptr_t)data;
+
+   drmModeRmFB(fd, fb);
+}
+
+// Each GBM buffer gets its DRM framebuffer once; it lives as the buffer's
+// user data until GBM destroys the buffer.
+static uint32_t kms_framebuffer(KmsPlatform* platform, struct gbm_bo* bo) {
+   uint32_t fb = (uint32_t)(uintptr_t)gbm_bo_get_user_data(bo);
+   if (fb) {
+      return fb;
+   }
+
+   uint32_t width = gbm_bo_get_width(bo);
+   uint32_t height = gbm_bo_get_height(bo);
+   uint32_t stride = gbm_bo_get_stride(bo);
+   uint32_t handle = gbm_bo_get_handle(bo).u32;
+
+   if (drmModeAddFB(platform->fd, width, height, 24, 32, stride, handle, &fb)) {
+      perror("Window: unable to add framebuffer.");
+      return 0;
+   }
+
+   gbm_bo_set_user_data(bo, (void*)(uintptr_t)fb, kms_destroy_framebuffer);
+
+   return fb;
+}
+
+static void kms_page_flip_handler(int fd, unsigned int frame, unsigned int sec, unsigned int usec, void* data) {
+   KmsPlatform* platform = data;
+
+   platform->flipPending = 0;
+   platform->flips++;
+}
+
+static void kms_wait_for_flip(KmsPlatform* platform) {
+   drmEventContext events;
+   memset(&events, 0, sizeof(events));
+   events.version = 2;
+   events.page_flip_handler = kms_page_flip_handler;
+
+   struct pollfd pfd = { platform->fd, POLLIN, 0 };
+
+   while (platform->flipPending) {
+      if (poll(&pfd, 1, -1) < 0) {
+         perror("Window: waiting for page flip failed.");
+         platform->flipPending = 0;
+         break;
+      }
+      drmHandleEvent(platform->fd, &events);
+   }
+}
+
+static void kms_swap(Window* window) {
+   KmsPlatform* platform = window->platform;
+
+   eglSwapBuffers(window->display, window->surface);
+
+   struct gbm_bo* bo = gbm_surface_lock_front_buffer(platform->surface);
+   uint32_t fb = kms_framebuffer(platform, bo);
+
+   if (!platform->bo) {
+      // First frame: set the mode with this buffer
+      if (drmModeSetCrtc(platform->fd, platform->crtcId, fb, 0, 0, &platform->connectorId, 1, &platform->mode)) {
+         perror("Window: unable to set mode.");
+      }
+   } else {
+      // The flip completes at the next vblank; until then the previous
+      // buffer is still being scanned out and can't be released.
+      platform->flipPending = 1;
+      if (drmModePageFlip(platform->fd, platform->crtcId, fb, DRM_MODE_PAGE_FLIP_EVENT, platform)) {
+         perror("Window: page flip failed.");
+         platform->flipPending = 0;
+      }
+      kms_wait_for_flip(platform);
+
+      gbm_surface_release_buffer(platform->surface, platform->bo);
+   }
+
+   platform->bo = bo;
+}
+
+static void kms_close(Window* window) {
+   KmsPlatform* platform = window->platform;
+   if (!platform) {
+      return;
+   }
+
+   if (platform->savedCrtc) {
+      drmModeCrtc* crtc = platform->savedCrtc;
+      drmModeSetCrtc(platform->fd, crtc->crtc_id, crtc->buffer_id, crtc->x, crtc->y, &platform->connectorId, 1, &crtc->mode);
+      drmModeFreeCrtc(crtc);
+   }
+
+   printf("Window: %u page flips\n", platform->flips);
+
+   if (platform->bo) {
+      gbm_surface_release_buffer(platform->surface, platform->bo);
+   }
+   if (platform->surface) {
+      gbm_surface_destroy(platform->surface);
+   }
+   if (platform->device) {
+      gbm_device_destroy(platform->device);
+   }
+   if (platform->fd != -1) {
+      close(platform->fd);
+   }
+
+   free(platform);
+   window->platform = NULL;
+}
+
+const WindowBackend windowKms = {
+   "kms",
+   kms_open,
+   kms_choose_config,
+   kms_create_surface,
+   NULL,
+   kms_swap,
+   kms_close
+};
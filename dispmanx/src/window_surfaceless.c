@@ -0,0 +1,99 @@
+#include "window.h"
+
+// No display at all: Mesa's surfaceless platform, rendering into an FBO of a
+// fixed size. Lets the renderer run and be benchmarked headless.
+
+#define SURFACELESS_WIDTH                                           1280
+#define SURFACELESS_HEIGHT                                           720
+
+typedef struct {
+   GLuint framebuffer;
+   GLuint colorRenderbuffer;
+   GLuint depthRenderbuffer;
+} SurfacelessPlatform;
+
+static char surfaceless_open(Window* window) {
+   PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+   if (!getPlatformDisplay) {
+      return 0;
+   }
+
+   window->display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+   window->width = SURFACELESS_WIDTH;
+   window->height = SURFACELESS_HEIGHT;
+
+   return window->display != EGL_NO_DISPLAY;
+}
+
+static EGLConfig surfaceless_choose_config(Window* window) {
+   // The FBO is single-sampled; multisampled renderbuffers need ES 3.0.
+   if (window->samples) {
+      fprintf(stderr, "Window: surfaceless has no MSAA, ignoring %dx.\n", window->samples);
+      window->samples = 0;
+   }
+
+   return window_choose_config(window, EGL_PBUFFER_BIT, 0);
+}
+
+static char surfaceless_create_surface(Window* window, EGLConfig config) {
+   SurfacelessPlatform* platform = NEW(SurfacelessPlatform, 1);
+   memset(platform, 0, sizeof(SurfacelessPlatform));
+   window->platform = platform;
+
+   if (!eglMakeCurrent(window->display, EGL_NO_SURFACE, EGL_NO_SURFACE, window->context)) {
+      return 0;
+   }
+
+   gl_resources_gen(GL_RESOURCE_RENDERBUFFER, &platform->colorRenderbuffer, "surfaceless color");
+   glBindRenderbuffer(GL_RENDERBUFFER, platform->colorRenderbuffer);
+   glRenderbufferStorage(GL_RENDERBUFFER, GL_RGB565, window->width, window->height);
+   gl_resources_storage(GL_RESOURCE_RENDERBUFFER, platform->colorRenderbuffer, window->width * window->height * 2);
+
+   gl_resources_gen(GL_RESOURCE_RENDERBUFFER, &platform->depthRenderbuffer, "surfaceless depth");
+   glBindRenderbuffer(GL_RENDERBUFFER, platform->depthRenderbuffer);
+   glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT16, window->width, window->height);
+   gl_resources_storage(GL_RESOURCE_RENDERBUFFER, platform->depthRenderbuffer, window->width * window->height * 2);
+
+   gl_resources_gen(GL_RESOURCE_FRAMEBUFFER, &platform->framebuffer, "surfaceless");
+   glBindFramebuffer(GL_FRAMEBUFFER, platform->framebuffer);
+   glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, platform->colorRenderbuffer);
+   glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, platform->depthRenderbuffer);
+
+   window->framebuffer = platform->framebuffer;
+
+   glCheck();
+
+   return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+}
+
+static void surfaceless_destroy_surface(Window* window) {
+   SurfacelessPlatform* platform = window->platform;
+   if (!platform) {
+      return;
+   }
+
+   gl_resources_delete(GL_RESOURCE_FRAMEBUFFER, &platform->framebuffer);
+   gl_resources_delete(GL_RESOURCE_RENDERBUFFER, &platform->depthRenderbuffer);
+   gl_resources_delete(GL_RESOURCE_RENDERBUFFER, &platform->colorRenderbuffer);
+   window->framebuffer = 0;
+}
+
+static void surfaceless_swap(Window* window) {
+   // Nothing is presented; waiting for the GPU keeps frame times honest.
+   glFinish();
+}
+
+static void surfaceless_close(Window* window) {
+   free(window->platform);
+   window->platform = NULL;
+}
+
+const WindowBackend windowSurfaceless = {
+   "surfaceless",
+   surfaceless_open,
+   surfaceless_choose_config,
+   surfaceless_create_surface,
+   surfaceless_destroy_surface,
+   surfaceless_swap,
+   surfaceless_close
+};
@@ -0,0 +1,198 @@
+#include "antialiasing.h"
+
+namespace {
+    const char* Names[] = { "off", "msaa2", "msaa4", "fxaa" };
+}
+
+bool AntiAliasing::parse(const std::string& name, Mode& mode) {
+    for (unsigned i = 0; i < sizeof(Names) / sizeof(Names[0]); i++) {
+        if (name == Names[i]) {
+            mode = static_cast<Mode>(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+std::string AntiAliasing::name(const Mode mode) {
+    return Names[static_cast<int>(mode)];
+}
+
+AntiAliasing::AntiAliasing()
+    : _mode(Mode::Off)
+    , _profiler(nullptr)
+    , _framebuffer(0)
+    , _colorTexture(0)
+    , _colorRenderbuffer(0)
+    , _depthRenderbuffer(0)
+    , _program(0)
+    , _vao(0)
+    , _vbo(0)
+    , _destination(0)
+    , _width(0)
+    , _height(0) {
+
+}
+
+void AntiAliasing::set_mode(const Mode mode) {
+    _mode = mode;
+}
+
+AntiAliasing::Mode AntiAliasing::mode() const {
+    return _mode;
+}
+
+void AntiAliasing::set_profiler(GpuProfiler* profiler) {
+    _profiler = profiler;
+}
+
+void AntiAliasing::init(ProgramCache& programCache, const std::string& vertexSource, const std::string& fragmentSource) {
+    std::cout << "AA: " << name(_mode) << std::endl;
+
+    if (_mode != Mode::FXAA)
+        return;
+
+    _program = GlResources::track(GlResources::Type::Program, programCache.build(vertexSource, fragmentSource), "fxaa");
+
+    glUseProgram(_program);
+    glUniform1i(glGetUniformLocation(_program, "tex"), 0);
+    glUseProgram(0);
+
+    // One triangle that covers the whole target
+    const GLfloat data[] = {
+        -1.0f, -1.0f,
+         3.0f, -1.0f,
+        -1.0f,  3.0f,
+    };
+
+    _vao = GlResources::gen(GlResources::Type::VertexArray, "fxaa");
+    _vbo = GlResources::gen(GlResources::Type::Buffer, "fxaa");
+
+    glBindVertexArray(_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(data), reinterpret_cast<const void*>(data), GL_STATIC_DRAW);
+    GlResources::set_storage(GlResources::Type::Buffer, _vbo, sizeof(data));
+
+    GLint positionLocation = glGetAttribLocation(_program, "position");
+    glEnableVertexAttribArray(positionLocation);
+    glVertexAttribPointer(positionLocation, 2, GL_FLOAT, false, 2 * sizeof(GLfloat), 0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+void AntiAliasing::destroy() {
+    destroy_target();
+
+    GlResources::remove(GlResources::Type::VertexArray, _vao);
+    GlResources::remove(GlResources::Type::Buffer, _vbo);
+    GlResources::remove(GlResources::Type::Program, _program);
+}
+
+void AntiAliasing::resize(const int width, const int height) {
+    _width = width;
+    _height = height;
+
+    if (_mode == Mode::Off)
+        return;
+
+    GLint previous;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous);
+
+    destroy_target();
+
+    _framebuffer = GlResources::gen(GlResources::Type::Framebuffer, "aa target");
+    glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+
+    _depthRenderbuffer = GlResources::gen(GlResources::Type::Renderbuffer, "aa depth");
+    glBindRenderbuffer(GL_RENDERBUFFER, _depthRenderbuffer);
+
+    if (_mode == Mode::FXAA) {
+        _colorTexture = GlResources::gen(GlResources::Type::Texture, "aa color");
+        glBindTexture(GL_TEXTURE_2D, _colorTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        GlResources::set_storage(GlResources::Type::Texture, _colorTexture, size_t(width) * height * 4);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _colorTexture, 0);
+
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+        GlResources::set_storage(GlResources::Type::Renderbuffer, _depthRenderbuffer, size_t(width) * height * 4);
+
+        glUseProgram(_program);
+        glUniform2f(glGetUniformLocation(_program, "texelSize"), 1.0f / width, 1.0f / height);
+        glUseProgram(0);
+    } else {
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples(), GL_DEPTH_COMPONENT24, width, height);
+        GlResources::set_storage(GlResources::Type::Renderbuffer, _depthRenderbuffer, size_t(width) * height * 4 * samples());
+
+        _colorRenderbuffer = GlResources::gen(GlResources::Type::Renderbuffer, "aa color");
+        glBindRenderbuffer(GL_RENDERBUFFER, _colorRenderbuffer);
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples(), GL_RGBA8, width, height);
+        GlResources::set_storage(GlResources::Type::Renderbuffer, _colorRenderbuffer, size_t(width) * height * 4 * samples());
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, _colorRenderbuffer);
+    }
+
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, _depthRenderbuffer);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "AA: " << name(_mode) << " target incomplete, turning anti-aliasing off." << std::endl;
+        destroy_target();
+        _mode = Mode::Off;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, previous);
+}
+
+void AntiAliasing::begin() {
+    if (_mode == Mode::Off)
+        return;
+
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &_destination);
+    glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+}
+
+void AntiAliasing::end() {
+    if (_profiler && _mode != Mode::Off)
+        _profiler->begin("post_process");
+
+    if (_mode == Mode::FXAA) {
+        glBindFramebuffer(GL_FRAMEBUFFER, _destination);
+
+        glDisable(GL_DEPTH_TEST);
+
+        glUseProgram(_program);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, _colorTexture);
+
+        glBindVertexArray(_vao);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindVertexArray(0);
+    } else if (_mode != Mode::Off) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, _framebuffer);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _destination);
+        glBlitFramebuffer(0, 0, _width, _height, 0, 0, _width, _height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, _destination);
+    }
+
+    if (_profiler && _mode != Mode::Off)
+        _profiler->end();
+}
+
+int AntiAliasing::samples() const {
+    switch (_mode) {
+        case Mode::MSAA2: return 2;
+        case Mode::MSAA4: return 4;
+        default:          return 0;
+    }
+}
+
+void AntiAliasing::destroy_target() {
+    GlResources::remove(GlResources::Type::Framebuffer, _framebuffer);
+    GlResources::remove(GlResources::Type::Texture, _colorTexture);
+    GlResources::remove(GlResources::Type::Renderbuffer, _colorRenderbuffer);
+    GlResources::remove(GlResources::Type::Renderbuffer, _depthRenderbuffer);
+}
@@ -0,0 +1,67 @@
+#ifndef ANTIALIASING_H
+#define ANTIALIASING_H
+
+#include <GL/glew.h>
+#include <iostream>
+#include <string>
+
+#include "gpuprofiler.h"
+#include "glresources.h"
+#include "programcache.h"
+
+// Anti-aliasing for the scene. GtkGLArea has no multisampled framebuffer of
+// its own, so MSAA renders into a multisampled offscreen target and resolves
+// it with a blit; FXAA renders into a texture and filters it in one pass.
+// The GPU profiler times the pass, so modes compare without waiting on the
+// GPU.
+class AntiAliasing {
+
+    public:
+        enum class Mode {
+            Off,
+            MSAA2,
+            MSAA4,
+            FXAA
+        };
+
+        static bool parse(const std::string& name, Mode& mode);
+        static std::string name(const Mode mode);
+
+        AntiAliasing();
+
+        void set_mode(const Mode mode);
+        Mode mode() const;
+
+        // Times the resolve or filter pass, if set.
+        void set_profiler(GpuProfiler* profiler);
+
+        void init(ProgramCache& programCache, const std::string& vertexSource, const std::string& fragmentSource);
+        void destroy();
+        void resize(const int width, const int height);
+
+        // Bracket the scene: begin binds the offscreen target, end resolves or
+        // filters it into the framebuffer that was bound at begin.
+        void begin();
+        void end();
+
+    private:
+        Mode _mode;
+        GpuProfiler* _profiler;
+
+        GLuint _framebuffer;
+        GLuint _colorTexture;
+        GLuint _colorRenderbuffer;
+        GLuint _depthRenderbuffer;
+        GLuint _program;
+        GLuint _vao;
+        GLuint _vbo;
+
+        GLint _destination;
+        int _width;
+        int _height;
+
+        int samples() const;
+        void destroy_target();
+};
+
+#endif // ANTIALIASING_H
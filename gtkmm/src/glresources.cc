@@ -0,0 +1,116 @@
+#include "glresources.h"
+
+namespace {
+    const char* Names[] = { "buffer", "texture", "renderbuffer", "framebuffer", "shader", "program", "vertex array" };
+}
+
+std::vector<GlResources::Resource> GlResources::_resources;
+
+GLuint GlResources::gen(const Type type, const char* label) {
+    GLuint name = 0;
+
+    switch (type) {
+        case Type::Buffer:       glGenBuffers(1, &name); break;
+        case Type::Texture:      glGenTextures(1, &name); break;
+        case Type::Renderbuffer: glGenRenderbuffers(1, &name); break;
+        case Type::Framebuffer:  glGenFramebuffers(1, &name); break;
+        case Type::VertexArray:  glGenVertexArrays(1, &name); break;
+        default:
+            // Shaders and programs are created with glCreate*; see track().
+            return 0;
+    }
+
+    return track(type, name, label);
+}
+
+GLuint GlResources::track(const Type type, const GLuint name, const char* label) {
+    if (name)
+        _resources.push_back({ type, name, label, 0 });
+
+    return name;
+}
+
+void GlResources::remove(const Type type, GLuint& name) {
+    if (!name)
+        return;
+
+    switch (type) {
+        case Type::Buffer:       glDeleteBuffers(1, &name); break;
+        case Type::Texture:      glDeleteTextures(1, &name); break;
+        case Type::Renderbuffer: glDeleteRenderbuffers(1, &name); break;
+        case Type::Framebuffer:  glDeleteFramebuffers(1, &name); break;
+        case Type::Shader:       glDeleteShader(name); break;
+        case Type::Program:      glDeleteProgram(name); break;
+        case Type::VertexArray:  glDeleteVertexArrays(1, &name); break;
+        default: break;
+    }
+
+    auto it = find(type, name);
+    if (it != _resources.end())
+        _resources.erase(it);
+
+    name = 0;
+}
+
+void GlResources::set_storage(const Type type, const GLuint name, const size_t bytes) {
+    auto it = find(type, name);
+    if (it != _resources.end())
+        it->bytes = bytes;
+}
+
+unsigned GlResources::count(const Type type) {
+    unsigned count = 0;
+    for (const Resource& resource : _resources)
+        count += resource.type == type;
+
+    return count;
+}
+
+size_t GlResources::bytes() {
+    size_t bytes = 0;
+    for (const Resource& resource : _resources)
+        bytes += resource.bytes;
+
+    return bytes;
+}
+
+void GlResources::report(std::ostream& out) {
+    out << "GL:";
+    for (int type = 0; type < static_cast<int>(Type::Count); type++) {
+        unsigned count = 0;
+        size_t bytes = 0;
+        for (const Resource& resource : _resources) {
+            if (resource.type == static_cast<Type>(type)) {
+                count++;
+                bytes += resource.bytes;
+            }
+        }
+
+        if (count) {
+            out << " " << count << " " << Names[type] << (count == 1 ? "" : "s");
+            if (bytes)
+                out << " (" << bytes / 1024.0 << " KB)";
+            out << ",";
+        }
+    }
+    out << " " << GlResources::bytes() / 1024.0 << " KB estimated in total" << std::endl;
+}
+
+unsigned GlResources::report_leaks(std::ostream& out) {
+    for (const Resource& resource : _resources)
+        out << "GL: leaked " << Names[static_cast<int>(resource.type)] << " " << resource.name << " \"" << resource.label << "\", " << resource.bytes << " bytes" << std::endl;
+
+    if (!_resources.empty())
+        out << "GL: " << _resources.size() << " resources leaked, " << bytes() / 1024.0 << " KB" << std::endl;
+
+    return _resources.size();
+}
+
+std::vector<GlResources::Resource>::iterator GlResources::find(const Type type, const GLuint name) {
+    for (auto it = _resources.begin(); it != _resources.end(); ++it) {
+        if (it->type == type && it->name == name)
+            return it;
+    }
+
+    return _resources.end();
+}
@@ -0,0 +1,63 @@
+#ifndef GLRESOURCES_H
+#define GLRESOURCES_H
+
+#include <GL/glew.h>
+#include <iostream>
+#include <vector>
+
+// The registry of every GL object the program holds, with the GPU memory
+// each is estimated to take. Objects are created and deleted through it;
+// whatever is still registered at shutdown is reported as a leak. GL is only
+// used from the main thread, so there is no locking.
+class GlResources {
+
+    public:
+        enum class Type {
+            Buffer,
+            Texture,
+            Renderbuffer,
+            Framebuffer,
+            Shader,
+            Program,
+            VertexArray,
+            Count
+        };
+
+        // Creates one object with glGen* and registers it under label, a
+        // string literal.
+        static GLuint gen(const Type type, const char* label);
+
+        // Registers an object created by glCreateShader or glCreateProgram.
+        static GLuint track(const Type type, const GLuint name, const char* label);
+
+        // Deletes the object with glDelete* and zeroes name. Names of 0 are
+        // ignored, as GL does.
+        static void remove(const Type type, GLuint& name);
+
+        // Records the estimated size of an object's storage, replacing any
+        // earlier estimate.
+        static void set_storage(const Type type, const GLuint name, const size_t bytes);
+
+        static unsigned count(const Type type);
+        static size_t bytes();
+
+        // The live count and estimated size of each kind of object.
+        static void report(std::ostream& out);
+
+        // Lists every object still registered; returns how many there are.
+        static unsigned report_leaks(std::ostream& out);
+
+    private:
+        struct Resource {
+            Type type;
+            GLuint name;
+            const char* label;
+            size_t bytes;
+        };
+
+        static std::vector<Resource> _resources;
+
+        static std::vector<Resource>::iterator find(const Type type, const GLuint name);
+};
+
+#endif // GLRESOURCES_H
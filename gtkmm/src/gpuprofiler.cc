@@ -0,0 +1,114 @@
+#include "gpuprofiler.h"
+
+GpuProfiler::GpuProfiler()
+    : _supported(false)
+    , _timing(false)
+    , _passes{}
+    , _passCount(0)
+    , _queries{}
+    , _pending{}
+    , _slot(0)
+    , _reportFrames(0)
+    , _reportMillis{}
+    , _reportSamples{}
+    , _discarded(0) {
+
+}
+
+void GpuProfiler::init() {
+    _supported = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+
+    if (!_supported) {
+        std::cout << "GPU profile: ARB_timer_query not available, passes are not timed" << std::endl;
+        return;
+    }
+
+    glGenQueries(Latency * MaxPasses, &_queries[0][0]);
+}
+
+void GpuProfiler::destroy() {
+    if (_supported) {
+        glDeleteQueries(Latency * MaxPasses, &_queries[0][0]);
+        _supported = false;
+    }
+}
+
+void GpuProfiler::begin(const char* pass) {
+    if (!_supported)
+        return;
+
+    int i = pass_index(pass);
+    if (i < 0)
+        return;
+
+    glBeginQuery(GL_TIME_ELAPSED, _queries[_slot][i]);
+    _pending[_slot][i] = true;
+    _timing = true;
+}
+
+void GpuProfiler::end() {
+    if (!_timing)
+        return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+    _timing = false;
+}
+
+void GpuProfiler::frame() {
+    if (!_supported)
+        return;
+
+    // The next slot holds the oldest frame's queries; collect them before
+    // they are reused.
+    _slot = (_slot + 1) % Latency;
+
+    for (unsigned i = 0; i < _passCount; i++) {
+        if (!_pending[_slot][i])
+            continue;
+        _pending[_slot][i] = false;
+
+        GLuint available = 0;
+        glGetQueryObjectuiv(_queries[_slot][i], GL_QUERY_RESULT_AVAILABLE, &available);
+
+        if (!available) {
+            _discarded++;
+            continue;
+        }
+
+        GLuint64 nanos;
+        glGetQueryObjectui64v(_queries[_slot][i], GL_QUERY_RESULT, &nanos);
+
+        _reportMillis[i] += nanos / 1e6;
+        _reportSamples[i]++;
+    }
+
+    if (++_reportFrames == ReportFrames) {
+        std::cout << "GPU profile:";
+        for (unsigned i = 0; i < _passCount; i++) {
+            if (_reportSamples[i])
+                std::cout << " " << _passes[i] << " " << _reportMillis[i] / _reportSamples[i] << " ms";
+            _reportMillis[i] = 0;
+            _reportSamples[i] = 0;
+        }
+        std::cout << " over " << _reportFrames << " frames";
+        if (_discarded)
+            std::cout << ", " << _discarded << " discarded";
+        std::cout << std::endl;
+
+        _reportFrames = 0;
+        _discarded = 0;
+    }
+}
+
+int GpuProfiler::pass_index(const char* pass) {
+    for (unsigned i = 0; i < _passCount; i++) {
+        if (_passes[i] == pass)
+            return i;
+    }
+
+    if (_passCount == MaxPasses)
+        return -1;
+
+    _passes[_passCount] = pass;
+    return _passCount++;
+}
@@ -0,0 +1,52 @@
+#ifndef GPUPROFILER_H
+#define GPUPROFILER_H
+
+#include <GL/glew.h>
+#include <iostream>
+#include <array>
+
+// GPU time per render pass, from ARB_timer_query. Each frame's queries go
+// into one slot of a ring and are read back Latency frames later, when they
+// have long finished, so reading never stalls. Without the extension every
+// call does nothing.
+class GpuProfiler {
+
+    public:
+        GpuProfiler();
+
+        void init();
+        void destroy();
+
+        // Bracket one pass. Passes are told apart by the name pointer, so use
+        // string literals; they must not nest.
+        void begin(const char* pass);
+        void end();
+
+        // Call once all of a frame's passes are submitted: reads back the
+        // oldest slot and prints the mean GPU time per pass periodically.
+        void frame();
+
+    private:
+        static constexpr unsigned MaxPasses = 8;
+        static constexpr unsigned Latency = 4;
+        static constexpr unsigned ReportFrames = 120;
+
+        bool _supported;
+        bool _timing;
+
+        std::array<const char*, MaxPasses> _passes;
+        unsigned _passCount;
+
+        GLuint _queries[Latency][MaxPasses];
+        bool _pending[Latency][MaxPasses];
+        unsigned _slot;
+
+        unsigned _reportFrames;
+        std::array<double, MaxPasses> _reportMillis;
+        std::array<unsigned, MaxPasses> _reportSamples;
+        unsigned _discarded;
+
+        int pass_index(const char* pass);
+};
+
+#endif // GPUPROFILER_H
@@ -1,14 +1,39 @@
 #include <gtkmm.h>
 #include <GL/glew.h>
+#include <iostream>
 
 #include "mainwindow.h"
+#include "startuptrace.h"
+#include "trace.h"
 
 int main(int argc, char** argv) {
+    StartupTrace::begin();
+    Trace::init("hello-triangle.trace.json");
+
     auto app = Gtk::Application::create(argc, argv, "org.nirjacobson.hello-triangle");
-    
+    StartupTrace::mark("Gtk::Application");
+
     MainWindow mainWindow;
-    
+    StartupTrace::mark("MainWindow");
+
+    // Options are handled before activation, so the GL area isn't realized yet.
+    app->add_main_option_entry(Gio::Application::OPTION_TYPE_STRING, "aa", '\0', "Anti-aliasing: off, msaa2, msaa4 or fxaa", "MODE");
+    app->signal_handle_local_options().connect([&mainWindow](const Glib::RefPtr<Glib::VariantDict>& options) {
+        Glib::ustring name;
+        if (options->lookup_value("aa", name)) {
+            AntiAliasing::Mode mode;
+            if (!AntiAliasing::parse(name, mode)) {
+                std::cerr << "Unknown anti-aliasing mode " << name << "; use off, msaa2, msaa4 or fxaa." << std::endl;
+                return 1;
+            }
+            mainWindow.set_anti_aliasing(mode);
+        }
+        return -1;
+    }, false);
+
     app->run(mainWindow);
 
+    Trace::write();
+
     return 0;
 }
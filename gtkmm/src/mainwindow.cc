@@ -3,7 +3,8 @@
 MainWindow::MainWindow() {
     auto refBuilder = Gtk::Builder::create();
 
-    refBuilder->add_from_file("ui/mainwindow.glade");
+    refBuilder->add_from_resource("/org/nirjacobson/hello-triangle/ui/mainwindow.glade");
+    StartupTrace::mark("Gtk::Builder");
     refBuilder->get_widget("mainWindow", _window);
     refBuilder->get_widget("xScale", _xScale);
     refBuilder->get_widget("yScale", _yScale);
@@ -41,7 +42,15 @@ MainWindow::MainWindow() {
 }
 
 MainWindow::~MainWindow() {
+    // Destroying the window unrealizes the GL area, which deletes its GL
+    // objects; anything left over was leaked.
     delete _window;
+
+    GlResources::report_leaks(std::cerr);
+}
+
+void MainWindow::set_anti_aliasing(const AntiAliasing::Mode mode) {
+    _glArea.set_anti_aliasing(mode);
 }
 
 void MainWindow::initScales() {
@@ -59,6 +68,8 @@ void MainWindow::initScales() {
 }
 
 void MainWindow::scaleValueChanged() {
+    TRACE_SCOPE("input");
+
     _glArea.setXRotation(_xScaleAdjustment->get_value());
     _glArea.setYRotation(_yScaleAdjustment->get_value());
     _glArea.setZRotation(_zScaleAdjustment->get_value());   
@@ -68,15 +79,18 @@ void MainWindow::animateButtonClicked() {
     _animate = !_animate;
 
     if (_animate) {
+        _rotation[0] = _previousRotation[0] = _xScale->get_value();
+        _rotation[1] = _previousRotation[1] = _yScale->get_value();
+        _rotation[2] = _previousRotation[2] = _zScale->get_value();
+
+        _simClock.reset();
+        _lastUpdate = std::chrono::steady_clock::now();
+
         _timer.setInterval([&](){
-            _dispatcher.emit();
+            Trace::set_thread_name("timer");
+            TRACE_SCOPE("timer_tick");
 
-            if (_xScale->get_value() >= 360.0f &&
-                _yScale->get_value() >= 360.0f &&
-                _zScale->get_value() >= 360.0f) {
-                    _timer.stop();
-                    _animate = false;
-                }
+            _dispatcher.emit();
         }, static_cast<int>(1000.0f / 30.0f));
     } else {
         _timer.stop();
@@ -88,9 +102,51 @@ void MainWindow::quitButtonClicked() {
 }
 
 void MainWindow::on_notification_from_timer_thread() {
-    _xScale->set_value(_xScale->get_value() + 1);
-    _yScale->set_value(_yScale->get_value() + 1);
-    _zScale->set_value(_zScale->get_value() + 1);
+    TRACE_SCOPE("animation_update");
+
+    // A tick may already be queued when the animation stops.
+    if (!_animate)
+        return;
+
+    const auto now = std::chrono::steady_clock::now();
+    const std::chrono::duration<double> elapsed = now - _lastUpdate;
+    _lastUpdate = now;
+
+    bool finished = false;
+    const unsigned steps = _simClock.advance(elapsed.count());
+    for (unsigned i = 0; i < steps && !finished; i++)
+        finished = step_animation();
+
+    const double alpha = finished ? 1.0 : _simClock.alpha();
+    double rotation[3];
+    for (int i = 0; i < 3; i++)
+        rotation[i] = _previousRotation[i] + (_rotation[i] - _previousRotation[i]) * alpha;
+
+    _xScale->set_value(rotation[0]);
+    _yScale->set_value(rotation[1]);
+    _zScale->set_value(rotation[2]);
+
+    // The scales round to whole degrees; the scene gets the exact rotation.
+    _glArea.setXRotation(rotation[0]);
+    _glArea.setYRotation(rotation[1]);
+    _glArea.setZRotation(rotation[2]);
+
+    if (finished) {
+        _timer.stop();
+        _animate = false;
+    }
+}
+
+bool MainWindow::step_animation() {
+    bool finished = true;
+
+    for (int i = 0; i < 3; i++) {
+        _previousRotation[i] = _rotation[i];
+        _rotation[i] = std::min(_rotation[i] + DegreesPerSecond * _simClock.step(), 360.0);
+        finished = finished && _rotation[i] >= 360.0;
+    }
+
+    return finished;
 }
 
 bool MainWindow::on_button_press_event(GdkEventButton* event) {
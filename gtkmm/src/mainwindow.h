@@ -3,9 +3,13 @@
 
 #include <gtkmm.h>
 #include <iostream>
+#include <chrono>
+#include <algorithm>
 
 #include "triangleglarea.h"
 #include "timercpp.h"
+#include "simclock.h"
+#include "startuptrace.h"
 
 class MainWindow {
     public:
@@ -14,7 +18,11 @@ class MainWindow {
 
         operator Gtk::Window&();
 
+        void set_anti_aliasing(const AntiAliasing::Mode mode);
+
     private:
+        static constexpr double DegreesPerSecond = 30.0;
+
         Gtk::Window* _window;
         Gtk::Scale* _xScale;
         Gtk::Scale* _yScale;
@@ -31,15 +39,23 @@ class MainWindow {
         Glib::RefPtr<Gtk::Adjustment> _yScaleAdjustment;
         Glib::RefPtr<Gtk::Adjustment> _zScaleAdjustment;
 
+        // The timer only wakes the main loop; the animation runs on the
+        // simulation clock, from the rotation after its latest step and the
+        // one before.
         Timer _timer;
         Glib::Dispatcher _dispatcher;
         bool _animate;
+        SimClock _simClock;
+        std::chrono::steady_clock::time_point _lastUpdate;
+        double _rotation[3];
+        double _previousRotation[3];
 
         void initScales();
         void scaleValueChanged();
         void animateButtonClicked();
         void quitButtonClicked();
         void on_notification_from_timer_thread();
+        bool step_animation();
         bool on_button_press_event(GdkEventButton* event);
         void take_screenshot();
 };
@@ -0,0 +1,247 @@
+#include "programcache.h"
+
+namespace {
+    uint64_t fnv1a(uint64_t hash, const char* str) {
+        if (!str) str = "";
+
+        // Include the terminator so that adjacent strings can't run together
+        do {
+            hash ^= static_cast<unsigned char>(*str);
+            hash *= 0x100000001b3ULL;
+        } while (*str++);
+
+        return hash;
+    }
+
+    uint64_t nanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+ProgramCache::ProgramCache()
+    : _supported(false)
+    , _hits(0)
+    , _misses(0)
+    , _rejections(0)
+    , _millisSaved(0) {
+
+}
+
+std::string ProgramCache::default_directory() {
+    if (const char* cacheHome = std::getenv("XDG_CACHE_HOME"))
+        return std::string(cacheHome) + "/hello-triangle";
+    if (const char* home = std::getenv("HOME"))
+        return std::string(home) + "/.cache/hello-triangle";
+    return "";
+}
+
+void ProgramCache::init(const std::string& directory) {
+    _directory = directory;
+    _supported = false;
+
+    if (_directory.empty())
+        return;
+
+    std::error_code error;
+    std::filesystem::create_directories(_directory, error);
+    if (error)
+        return;
+
+    GLint formats = 0;
+    if (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary)
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+
+    _supported = formats > 0;
+}
+
+GLuint ProgramCache::build(const std::string& vertexSource, const std::string& fragmentSource, const std::string& defines) {
+    if (!_supported)
+        return compile_program(vertexSource, fragmentSource, defines);
+
+    const std::string cachePath = path(key(vertexSource, fragmentSource, defines));
+
+    uint64_t start = nanos();
+    uint64_t buildNanos = 0;
+
+    GLuint program = load(cachePath, buildNanos);
+    if (program) {
+        uint64_t loadNanos = nanos() - start;
+
+        _hits++;
+        if (buildNanos > loadNanos)
+            _millisSaved += (buildNanos - loadNanos) / 1e6;
+
+        return program;
+    }
+
+    _misses++;
+
+    start = nanos();
+    program = compile_program(vertexSource, fragmentSource, defines);
+    buildNanos = nanos() - start;
+
+    store(cachePath, program, buildNanos);
+
+    return program;
+}
+
+void ProgramCache::report(std::ostream& out) const {
+    if (!_supported) {
+        out << "Program cache: program binaries unavailable, programs compiled from source." << std::endl;
+        return;
+    }
+
+    unsigned lookups = _hits + _misses;
+    out << "Program cache: " << _hits << " hits, " << _misses << " misses, " << _rejections << " rejected ("
+        << (lookups ? 100 * _hits / lookups : 0) << "% hit rate), " << _millisSaved << " ms saved." << std::endl;
+}
+
+std::string ProgramCache::path(uint64_t key) const {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return (_directory / name).string();
+}
+
+uint64_t ProgramCache::key(const std::string& vertexSource, const std::string& fragmentSource, const std::string& defines) const {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    hash = fnv1a(hash, reinterpret_cast<const char*>(glGetString(GL_VENDOR)));
+    hash = fnv1a(hash, reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+    hash = fnv1a(hash, reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+    hash = fnv1a(hash, defines.c_str());
+    hash = fnv1a(hash, vertexSource.c_str());
+    hash = fnv1a(hash, fragmentSource.c_str());
+
+    return hash;
+}
+
+GLuint ProgramCache::load(const std::string& path, uint64_t& buildNanos) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return 0;
+
+    Header header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        header.magic != Magic ||
+        header.version != Version)
+        return 0;
+
+    // The length comes from the file; a corrupt one mustn't size the
+    // allocation.
+    const std::streampos dataStart = file.tellg();
+    file.seekg(0, std::ios::end);
+    const std::streamoff available = file.tellg() - dataStart;
+    file.seekg(dataStart);
+    if (header.length == 0 || header.length > available)
+        return 0;
+
+    std::vector<char> binary(header.length);
+    if (!file.read(binary.data(), binary.size()))
+        return 0;
+
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, header.format, binary.data(), binary.size());
+
+    GLint status;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+
+    // Clear any error raised by a rejected binary.
+    glGetError();
+
+    if (status != GL_TRUE) {
+        // The driver rejected the binary, e.g. after a driver update.
+        glDeleteProgram(program);
+        _rejections++;
+        return 0;
+    }
+
+    buildNanos = header.buildNanos;
+    return program;
+}
+
+void ProgramCache::store(const std::string& path, GLuint program, uint64_t buildNanos) const {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    std::vector<char> binary(length);
+    GLenum format;
+    GLsizei written;
+    glGetProgramBinary(program, length, &written, &format, binary.data());
+
+    Header header = { Magic, Version, format, static_cast<uint32_t>(written), buildNanos };
+
+    // Write to a temporary file and rename it into place, so that a concurrent
+    // reader never sees a partially written binary.
+    const std::string tmpPath = path + "." + std::to_string(getpid()) + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(binary.data(), written);
+        if (!file) {
+            file.close();
+            std::remove(tmpPath.c_str());
+            return;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tmpPath, path, error);
+    if (error)
+        std::remove(tmpPath.c_str());
+}
+
+GLuint ProgramCache::compile_program(const std::string& vertexSource, const std::string& fragmentSource, const std::string& defines) const {
+    GLuint vertexShader = compile_shader(GL_VERTEX_SHADER, vertexSource, defines);
+    GLuint fragmentShader = compile_shader(GL_FRAGMENT_SHADER, fragmentSource, defines);
+
+    GLuint program = glCreateProgram();
+    if (_supported)
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+
+    GLint status;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE) {
+        GLchar log[1024];
+        glGetProgramInfoLog(program, sizeof(log), NULL, log);
+        std::cerr << "Program: linking failed." << std::endl << log << std::endl;
+    }
+
+    // The program keeps the compiled code; the shader objects are no longer needed.
+    glDetachShader(program, vertexShader);
+    glDetachShader(program, fragmentShader);
+    GlResources::remove(GlResources::Type::Shader, vertexShader);
+    GlResources::remove(GlResources::Type::Shader, fragmentShader);
+
+    return program;
+}
+
+GLuint ProgramCache::compile_shader(GLenum type, const std::string& source, const std::string& defines) {
+    // Defines have to follow the #version directive.
+    std::string::size_type insertAt = 0;
+    if (source.compare(0, 8, "#version") == 0)
+        insertAt = source.find('\n') + 1;
+
+    const std::string fullSource = source.substr(0, insertAt) + defines + source.substr(insertAt);
+    const GLchar* sourceCstr = fullSource.c_str();
+
+    GLuint shader = GlResources::track(GlResources::Type::Shader, glCreateShader(type), type == GL_VERTEX_SHADER ? "vertex shader" : "fragment shader");
+    glShaderSource(shader, 1, &sourceCstr, NULL);
+    glCompileShader(shader);
+
+    GLint status;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status != GL_TRUE) {
+        GLchar log[1024];
+        glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+        std::cerr << "Shader: compilation failed." << std::endl << log << std::endl;
+    }
+
+    return shader;
+}
@@ -0,0 +1,57 @@
+#ifndef PROGRAMCACHE_H
+#define PROGRAMCACHE_H
+
+#include <GL/glew.h>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <unistd.h>
+
+#include "glresources.h"
+
+class ProgramCache {
+
+    public:
+        ProgramCache();
+
+        void init(const std::string& directory = default_directory());
+        GLuint build(const std::string& vertexSource, const std::string& fragmentSource, const std::string& defines = "");
+        void report(std::ostream& out) const;
+
+        static std::string default_directory();
+
+    private:
+        struct Header {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t format;
+            uint32_t length;
+            uint64_t buildNanos;
+        };
+
+        static constexpr uint32_t Magic = 0x43505448; // "HTPC"
+        static constexpr uint32_t Version = 1;
+
+        std::filesystem::path _directory;
+        bool _supported;
+
+        unsigned _hits;
+        unsigned _misses;
+        unsigned _rejections;
+        double _millisSaved;
+
+        std::string path(uint64_t key) const;
+        uint64_t key(const std::string& vertexSource, const std::string& fragmentSource, const std::string& defines) const;
+        GLuint load(const std::string& path, uint64_t& buildNanos);
+        void store(const std::string& path, GLuint program, uint64_t buildNanos) const;
+
+        GLuint compile_program(const std::string& vertexSource, const std::string& fragmentSource, const std::string& defines) const;
+        static GLuint compile_shader(GLenum type, const std::string& source, const std::string& defines);
+};
+
+#endif // PROGRAMCACHE_H
@@ -0,0 +1,46 @@
+#include "simclock.h"
+
+SimClock::SimClock(const double step, const unsigned max_steps)
+    : _step(step)
+    , _maxSteps(max_steps)
+    , _accumulator(0)
+    , _steps(0)
+    , _droppedSeconds(0) {
+
+}
+
+void SimClock::reset() {
+    _accumulator = 0;
+}
+
+unsigned SimClock::advance(const double seconds) {
+    _accumulator += seconds;
+
+    const double limit = _maxSteps * _step;
+    if (_accumulator > limit) {
+        _droppedSeconds += _accumulator - limit;
+        _accumulator = limit;
+    }
+
+    const unsigned steps = static_cast<unsigned>(_accumulator / _step);
+    _accumulator -= steps * _step;
+    _steps += steps;
+
+    return steps;
+}
+
+double SimClock::alpha() const {
+    return _accumulator / _step;
+}
+
+double SimClock::step() const {
+    return _step;
+}
+
+uint64_t SimClock::steps() const {
+    return _steps;
+}
+
+double SimClock::dropped_seconds() const {
+    return _droppedSeconds;
+}
@@ -0,0 +1,42 @@
+#ifndef SIMCLOCK_H
+#define SIMCLOCK_H
+
+#include <cstdint>
+
+// Runs the simulation in fixed steps, whatever the rate it is drawn at:
+// each update adds the time since the last, and the simulation advances a
+// whole number of steps. The time left over is the fraction of a step to
+// interpolate the drawn state by. After a stall only max_steps are caught
+// up and the rest is dropped, so that one slow update doesn't make the
+// next slower still.
+class SimClock {
+
+    public:
+        static constexpr double DefaultStep = 1.0 / 60.0;
+        static constexpr unsigned DefaultMaxSteps = 5;
+
+        SimClock(const double step = DefaultStep, const unsigned max_steps = DefaultMaxSteps);
+
+        // Forgets the time accumulated, e.g. when the simulation is resumed.
+        void reset();
+
+        // Adds the seconds elapsed and returns how many steps to run.
+        unsigned advance(const double seconds);
+
+        // How far the next step has progressed, from 0 to 1.
+        double alpha() const;
+
+        double step() const;
+        uint64_t steps() const;
+        double dropped_seconds() const;
+
+    private:
+        double _step;
+        unsigned _maxSteps;
+        double _accumulator;
+
+        uint64_t _steps;
+        double _droppedSeconds;
+};
+
+#endif // SIMCLOCK_H
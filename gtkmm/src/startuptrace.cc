@@ -0,0 +1,37 @@
+#include "startuptrace.h"
+
+StartupTrace::Clock::time_point StartupTrace::_start;
+std::vector<StartupTrace::Mark> StartupTrace::_marks;
+std::mutex StartupTrace::_mutex;
+
+void StartupTrace::begin() {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _start = Clock::now();
+    _marks.clear();
+}
+
+void StartupTrace::mark(const std::string& phase) {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _marks.push_back({ phase, Clock::now() });
+}
+
+void StartupTrace::report(std::ostream& out) {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto millis = [](Clock::time_point from, Clock::time_point to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    };
+
+    Clock::time_point previous = _start;
+
+    out << "Startup:" << std::endl << std::fixed << std::setprecision(2);
+    for (const Mark& mark : _marks) {
+        out << "  " << std::left << std::setw(24) << mark.phase << std::right
+            << std::setw(8) << millis(previous, mark.time) << " ms "
+            << std::setw(8) << millis(_start, mark.time) << " ms" << std::endl;
+        previous = mark.time;
+    }
+    out << std::defaultfloat;
+}
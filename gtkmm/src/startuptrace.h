@@ -0,0 +1,31 @@
+#ifndef STARTUPTRACE_H
+#define STARTUPTRACE_H
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class StartupTrace {
+
+    public:
+        static void begin();
+        static void mark(const std::string& phase);
+        static void report(std::ostream& out);
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        struct Mark {
+            std::string phase;
+            Clock::time_point time;
+        };
+
+        static Clock::time_point _start;
+        static std::vector<Mark> _marks;
+        static std::mutex _mutex;
+};
+
+#endif // STARTUPTRACE_H
@@ -2,7 +2,7 @@
 
 void Timer::setTimeout(std::function<void(void)> function, int delay) {
     this->clear = false;
-    std::thread t([=]() {
+    std::thread t([this, function = std::move(function), delay]() {
         if(this->clear) return;
         std::this_thread::sleep_for(std::chrono::milliseconds(delay));
         if(this->clear) return;
@@ -13,7 +13,8 @@ void Timer::setTimeout(std::function<void(void)> function, int delay) {
 
 void Timer::setInterval(std::function<void(void)> function, int interval) {
     this->clear = false;
-    std::thread t([=]() {
+    // The function is moved into the thread rather than copied again.
+    std::thread t([this, function = std::move(function), interval]() {
         while(true) {
             if(this->clear) return;
             std::this_thread::sleep_for(std::chrono::milliseconds(interval));
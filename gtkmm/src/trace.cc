@@ -0,0 +1,118 @@
+#include "trace.h"
+
+#ifdef HAVE_TRACE
+
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <glib-unix.h>
+
+std::string Trace::_path;
+std::atomic<Trace::Buffer*> Trace::_buffers;
+thread_local Trace::Buffer* Trace::_threadBuffer;
+
+void Trace::init(const std::string& path) {
+    const char* environment = std::getenv("TRACE_FILE");
+    _path = environment ? environment : path;
+
+    // The handler runs on the main loop, where writing the file is safe.
+    g_unix_signal_add(SIGUSR1, [](gpointer) -> gboolean {
+        write();
+        return G_SOURCE_CONTINUE;
+    }, nullptr);
+
+    set_thread_name("main");
+    std::cout << "Trace: writing " << _path << " on exit or SIGUSR1" << std::endl;
+}
+
+void Trace::set_thread_name(const char* name) {
+    thread_buffer()->threadName = name;
+}
+
+void Trace::write() {
+    std::ofstream file(_path);
+    if (!file) {
+        std::cerr << "Trace: couldn't write " << _path << std::endl;
+        return;
+    }
+
+    auto micros = [](Clock::duration duration) {
+        return std::chrono::duration<double, std::micro>(duration).count();
+    };
+
+    long pid = getpid();
+    size_t total = 0;
+    const char* separator = "";
+
+    file << "{\"traceEvents\":[" << std::endl << std::fixed;
+
+    for (Buffer* buffer = _buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+        size_t count = buffer->count.load(std::memory_order_acquire);
+
+        if (buffer->threadName) {
+            file << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+                 << ",\"tid\":" << buffer->tid << ",\"args\":{\"name\":\"" << buffer->threadName << "\"}}";
+            separator = ",\n";
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            const Event& event = buffer->events[i];
+
+            file << separator << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"ts\":"
+                 << micros(event.begin.time_since_epoch()) << ",\"dur\":" << micros(event.end - event.begin)
+                 << ",\"pid\":" << pid << ",\"tid\":" << buffer->tid << "}";
+            separator = ",\n";
+        }
+
+        total += count;
+        if (buffer->dropped) {
+            std::cerr << "Trace: thread " << buffer->tid << " dropped " << buffer->dropped << " events" << std::endl;
+        }
+    }
+
+    file << std::endl << "]}" << std::endl;
+
+    std::cout << "Trace: " << total << " events written to " << _path << std::endl;
+}
+
+Trace::Buffer* Trace::thread_buffer() {
+    if (_threadBuffer)
+        return _threadBuffer;
+
+    // Buffers outlive their threads so write() can still read them.
+    Buffer* buffer = new Buffer();
+    buffer->threadName = nullptr;
+    buffer->tid = syscall(SYS_gettid);
+    buffer->dropped = 0;
+
+    buffer->next = _buffers.load(std::memory_order_relaxed);
+    while (!_buffers.compare_exchange_weak(buffer->next, buffer, std::memory_order_release, std::memory_order_relaxed));
+
+    _threadBuffer = buffer;
+    return buffer;
+}
+
+void Trace::record(const char* name, Clock::time_point begin, Clock::time_point end) {
+    Buffer* buffer = thread_buffer();
+
+    // Once full, new spans are dropped so what was written stays consistent.
+    size_t count = buffer->count.load(std::memory_order_relaxed);
+    if (count == EventsPerThread) {
+        buffer->dropped++;
+        return;
+    }
+
+    buffer->events[count] = { name, begin, end };
+    buffer->count.store(count + 1, std::memory_order_release);
+}
+
+Trace::Scope::Scope(const char* name)
+    : _name(name)
+    , _begin(Clock::now()) {
+}
+
+Trace::Scope::~Scope() {
+    record(_name, _begin, Clock::now());
+}
+
+#endif // HAVE_TRACE
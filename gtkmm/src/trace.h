@@ -0,0 +1,87 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <string>
+
+// Scoped trace spans, written as Chrome trace-event JSON for chrome://tracing
+// or ui.perfetto.dev. Built with `make TRACE=1`; otherwise TRACE_SCOPE expands
+// to nothing and the rest of the interface is empty.
+//
+//   TRACE_SCOPE("draw");     // span from here to the end of the block
+
+#ifdef HAVE_TRACE
+
+#include <iostream>
+#include <fstream>
+#include <atomic>
+#include <array>
+#include <chrono>
+
+class Trace {
+
+    public:
+        // Writes to path, or $TRACE_FILE, at exit and on SIGUSR1.
+        static void init(const std::string& path);
+        static void set_thread_name(const char* name);
+        static void write();
+
+        class Scope {
+
+            public:
+                Scope(const char* name);
+                ~Scope();
+
+            private:
+                const char* _name;
+                std::chrono::steady_clock::time_point _begin;
+        };
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        static constexpr size_t EventsPerThread = 65536;
+
+        struct Event {
+            const char* name;
+            Clock::time_point begin;
+            Clock::time_point end;
+        };
+
+        // Each thread records into its own buffer, so recording takes no lock;
+        // write() only reads the events the owner has published through count.
+        struct Buffer {
+            Buffer* next;
+            const char* threadName;
+            long tid;
+            std::atomic<size_t> count;
+            size_t dropped;
+            std::array<Event, EventsPerThread> events;
+        };
+
+        static std::string _path;
+        static std::atomic<Buffer*> _buffers;
+        static thread_local Buffer* _threadBuffer;
+
+        static Buffer* thread_buffer();
+        static void record(const char* name, Clock::time_point begin, Clock::time_point end);
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) Trace::Scope TRACE_CONCAT(_traceScope, __LINE__)(name)
+
+#else
+
+class Trace {
+
+    public:
+        static void init(const std::string&) {}
+        static void set_thread_name(const char*) {}
+        static void write() {}
+};
+
+#define TRACE_SCOPE(name)
+
+#endif // HAVE_TRACE
+
+#endif // TRACE_H
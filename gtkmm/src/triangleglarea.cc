@@ -1,15 +1,20 @@
 #include "triangleglarea.h"
 
-TriangleGLArea::TriangleGLArea() {
-
-}
-
-TriangleGLArea::~TriangleGLArea() {
-    glDeleteVertexArrays(1, &_vao);
-    glDeleteBuffers(1, &_vbo);
-    glDeleteProgram(_program);
-    glDeleteShader(_vertexShader);
-    glDeleteShader(_fragmentShader);
+TriangleGLArea::TriangleGLArea()
+    : _vao(0)
+    , _vbo(0)
+    , _program(0)
+    , _firstRender(true) {
+
+    // Fetch the shader sources while the window is built and the GL context
+    // is created; only compiling them needs the context.
+    _shaderSources = std::async(std::launch::async, []() {
+        auto sources = std::make_pair(
+            load_resource("/org/nirjacobson/hello-triangle/src/program.vert"),
+            load_resource("/org/nirjacobson/hello-triangle/src/program.frag"));
+        StartupTrace::mark("load shaders (worker)");
+        return sources;
+    });
 }
 
 void TriangleGLArea::setXRotation(const double x) {
@@ -27,26 +32,74 @@ void TriangleGLArea::setZRotation(const double z) {
     queue_render();
 }
 
+void TriangleGLArea::set_anti_aliasing(const AntiAliasing::Mode mode) {
+    _antiAliasing.set_mode(mode);
+}
+
 void TriangleGLArea::on_realize() {
     Gtk::GLArea::on_realize();
 
     make_current();
+    StartupTrace::mark("GL context");
+
     glewExperimental = true;
     if (glewInit() != GLEW_OK) {
         std::cerr << "glewInit() failed." << std::endl;
     }
+    StartupTrace::mark("glewInit");
 
     glClearColor(0, 0, 0, 1);
 
+    _gpuProfiler.init();
+    _antiAliasing.set_profiler(&_gpuProfiler);
+
     init_vertex_array();
     init_vertex_buffer();
     init_program();
     layout();
+    StartupTrace::mark("init GL resources");
+
+    GlResources::report(std::cout);
+}
+
+void TriangleGLArea::on_unrealize() {
+    // The context goes with the widget's window, and GL objects can only be
+    // deleted while it is current, so they go here rather than in the
+    // destructor.
+    make_current();
+
+    if (!has_error()) {
+        GlResources::remove(GlResources::Type::VertexArray, _vao);
+        GlResources::remove(GlResources::Type::Buffer, _vbo);
+        GlResources::remove(GlResources::Type::Program, _program);
+        _antiAliasing.destroy();
+        _gpuProfiler.destroy();
+    }
+
+    Gtk::GLArea::on_unrealize();
 }
 
 bool TriangleGLArea::on_render(const Glib::RefPtr< Gdk::GLContext >& context) {
+    TRACE_SCOPE("on_render");
+
+    _antiAliasing.begin();
+    _gpuProfiler.begin("triangle");
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     draw();
+    _gpuProfiler.end();
+    {
+        TRACE_SCOPE("post_process");
+        _antiAliasing.end();
+    }
+    _gpuProfiler.frame();
+
+    if (_firstRender) {
+        // GtkGLArea presents its framebuffer when the frame clock finishes
+        // painting, so the first swap is complete once "after-paint" fires.
+        g_signal_connect(gtk_widget_get_frame_clock(GTK_WIDGET(gobj())), "after-paint",
+            G_CALLBACK(&TriangleGLArea::on_first_frame_painted), this);
+        _firstRender = false;
+    }
 
     Gtk::Container* container = get_toplevel();
     Gtk::Window* window = dynamic_cast<Gtk::Window*>(container);
@@ -57,6 +110,8 @@ bool TriangleGLArea::on_render(const Glib::RefPtr< Gdk::GLContext >& context) {
 
 void TriangleGLArea::on_resize(int width, int height) {
     Gtk::GLArea::on_resize(width, height);
+
+    _antiAliasing.resize(width, height);
     
     float aspect = static_cast<float>(width) / height;
     glm::mat4 projection(
@@ -73,11 +128,11 @@ void TriangleGLArea::on_resize(int width, int height) {
 }
 
 void TriangleGLArea::init_vertex_array() {
-    glGenVertexArrays(1, &_vao);
+    _vao = GlResources::gen(GlResources::Type::VertexArray, "triangle");
 }
 
 void TriangleGLArea::init_vertex_buffer() {
-    glGenBuffers(1, &_vbo);
+    _vbo = GlResources::gen(GlResources::Type::Buffer, "triangle");
 
     const GLfloat data[] = {
         -0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f,    // left vertex, red
@@ -87,29 +142,40 @@ void TriangleGLArea::init_vertex_buffer() {
 
     glBindBuffer(GL_ARRAY_BUFFER, _vbo);
     glBufferData(GL_ARRAY_BUFFER, sizeof(data), reinterpret_cast<const void*>(data), GL_DYNAMIC_DRAW);
+    GlResources::set_storage(GlResources::Type::Buffer, _vbo, sizeof(data));
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 void TriangleGLArea::init_program() {
-    _vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    _fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    _program = glCreateProgram();
+    _programCache.init();
+
+    const auto& sources = _shaderSources.get();
+    _program = GlResources::track(GlResources::Type::Program, _programCache.build(sources.first, sources.second), "triangle");
+
+    if (_antiAliasing.mode() == AntiAliasing::Mode::FXAA) {
+        _antiAliasing.init(_programCache,
+            load_resource("/org/nirjacobson/hello-triangle/src/fxaa.vert"),
+            load_resource("/org/nirjacobson/hello-triangle/src/fxaa.frag"));
+    } else {
+        _antiAliasing.init(_programCache, "", "");
+    }
 
-    std::ifstream vertIfstream("src/program.vert");
-    std::string vertSource((std::istreambuf_iterator<char>(vertIfstream)), std::istreambuf_iterator<char>());
-    const char* vertSourceCstr = vertSource.c_str();
-    glShaderSource(_vertexShader, 1, &vertSourceCstr, NULL);
-    glCompileShader(_vertexShader);
+    _programCache.report(std::cout);
+}
+
+std::string TriangleGLArea::load_resource(const std::string& resourcePath) {
+    gsize size;
+    auto bytes = Gio::Resource::lookup_data_global(resourcePath);
+    const char* data = static_cast<const char*>(bytes->get_data(size));
+
+    return std::string(data, size);
+}
 
-    std::ifstream fragIfstream("src/program.frag");
-    std::string fragSource((std::istreambuf_iterator<char>(fragIfstream)), std::istreambuf_iterator<char>());
-    const char* fragSourceCstr = fragSource.c_str();
-    glShaderSource(_fragmentShader, 1, &fragSourceCstr, NULL);
-    glCompileShader(_fragmentShader);
+void TriangleGLArea::on_first_frame_painted(GdkFrameClock* frameClock, gpointer data) {
+    g_signal_handlers_disconnect_by_func(frameClock, reinterpret_cast<gpointer>(&TriangleGLArea::on_first_frame_painted), data);
 
-    glAttachShader(_program, _vertexShader);
-    glAttachShader(_program, _fragmentShader);
-    glLinkProgram(_program);
+    StartupTrace::mark("first swap");
+    StartupTrace::report(std::cout);
 }
 
 void TriangleGLArea::layout() {
@@ -132,14 +198,20 @@ void TriangleGLArea::layout() {
 }
 
 void TriangleGLArea::draw() {
+    TRACE_SCOPE("draw_triangle");
+
     glm::mat4 model(1.0f);
 
-    float xRadians = _xRotation * 2 * M_PI / 360.0f;
-    float yRadians = _yRotation * 2 * M_PI / 360.0f;
-    float zRadians = _zRotation * 2 * M_PI / 360.0f;
-    model = glm::rotate(model, xRadians, glm::vec3(1, 0, 0));
-    model = glm::rotate(model, yRadians, glm::vec3(0, 1, 0));
-    model = glm::rotate(model, zRadians, glm::vec3(0, 0, 1));
+    {
+        TRACE_SCOPE("update_model");
+
+        float xRadians = _xRotation * 2 * M_PI / 360.0f;
+        float yRadians = _yRotation * 2 * M_PI / 360.0f;
+        float zRadians = _zRotation * 2 * M_PI / 360.0f;
+        model = glm::rotate(model, xRadians, glm::vec3(1, 0, 0));
+        model = glm::rotate(model, yRadians, glm::vec3(0, 1, 0));
+        model = glm::rotate(model, zRadians, glm::vec3(0, 0, 1));
+    }
 
     glUseProgram(_program);
 
@@ -3,34 +3,47 @@
 
 #include <gtkmm/glarea.h>
 #include <gtkmm/window.h>
+#include <giomm/resource.h>
 #include <GL/glew.h>
 #include <iostream>
 #include <string>
-#include <fstream>
-#include <streambuf>
+#include <future>
+#include <utility>
 #include <glm/glm.hpp>
 #include <glm/vec3.hpp>
 #include <glm/mat4x4.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "antialiasing.h"
+#include "glresources.h"
+#include "programcache.h"
+#include "startuptrace.h"
+#include "trace.h"
+
 class TriangleGLArea : public Gtk::GLArea {
 
     public:
         TriangleGLArea();
-        ~TriangleGLArea();
 
         void setXRotation(const double x);
         void setYRotation(const double y);
         void setZRotation(const double z);
 
+        // Takes effect when the area is realized.
+        void set_anti_aliasing(const AntiAliasing::Mode mode);
+
     private:
         GLuint _vao;
         GLuint _vbo;
-        GLuint _vertexShader;
-        GLuint _fragmentShader;
         GLuint _program;
 
+        ProgramCache _programCache;
+        AntiAliasing _antiAliasing;
+        GpuProfiler _gpuProfiler;
+        std::shared_future<std::pair<std::string, std::string>> _shaderSources;
+        bool _firstRender;
+
         double _xRotation;
         double _yRotation;
         double _zRotation;
@@ -38,10 +51,13 @@ class TriangleGLArea : public Gtk::GLArea {
         void init_vertex_array();
         void init_vertex_buffer();
         void init_program();
+        static std::string load_resource(const std::string& resourcePath);
+        static void on_first_frame_painted(GdkFrameClock* frameClock, gpointer data);
         void layout();
         void draw();
 
         void on_realize() override;
+        void on_unrealize() override;
         bool on_render(const Glib::RefPtr< Gdk::GLContext >& context) override;
         void on_resize(int width, int height) override;
 };
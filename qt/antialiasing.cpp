@@ -0,0 +1,46 @@
+#include "antialiasing.h"
+
+#include <QStringList>
+
+namespace {
+    const QStringList Names = { "off", "msaa2", "msaa4", "fxaa" };
+}
+
+AntiAliasing::Mode AntiAliasing::_mode = AntiAliasing::Mode::Off;
+
+bool AntiAliasing::parse(const QString& name, Mode& mode)
+{
+    const int index = Names.indexOf(name);
+    if (index < 0)
+        return false;
+
+    mode = static_cast<Mode>(index);
+    return true;
+}
+
+QString AntiAliasing::name(const Mode mode)
+{
+    return Names[static_cast<int>(mode)];
+}
+
+int AntiAliasing::samples(const Mode mode)
+{
+    switch (mode) {
+    case Mode::MSAA2:
+        return 2;
+    case Mode::MSAA4:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+void AntiAliasing::setMode(const Mode mode)
+{
+    _mode = mode;
+}
+
+AntiAliasing::Mode AntiAliasing::mode()
+{
+    return _mode;
+}
@@ -0,0 +1,30 @@
+#ifndef ANTIALIASING_H
+#define ANTIALIASING_H
+
+#include <QString>
+
+// The application-wide anti-aliasing mode, chosen once at startup. MSAA is
+// requested through the surface format; FXAA is a filter pass the renderer
+// applies to an offscreen copy of the scene.
+class AntiAliasing
+{
+public:
+    enum class Mode {
+        Off,
+        MSAA2,
+        MSAA4,
+        FXAA
+    };
+
+    static bool parse(const QString& name, Mode& mode);
+    static QString name(const Mode mode);
+    static int samples(const Mode mode);
+
+    static void setMode(const Mode mode);
+    static Mode mode();
+
+private:
+    static Mode _mode;
+};
+
+#endif // ANTIALIASING_H
@@ -0,0 +1,81 @@
+#include "framestatistics.h"
+
+FrameStatistics::FrameStatistics(int window)
+    : _frames(window, 0)
+    , _next(0)
+    , _count(0)
+    , _total(0)
+{
+    _sorted.reserve(window);
+}
+
+void FrameStatistics::addFrame(const qint64 nsecs)
+{
+    _total += nsecs - _frames[_next];
+    _frames[_next] = nsecs;
+
+    _next = (_next + 1) % _frames.size();
+    _count = std::min(_count + 1, static_cast<int>(_frames.size()));
+}
+
+void FrameStatistics::reset()
+{
+    _frames.fill(0);
+    _next = 0;
+    _count = 0;
+    _total = 0;
+}
+
+int FrameStatistics::count() const
+{
+    return _count;
+}
+
+double FrameStatistics::fps() const
+{
+    return _total > 0 ? _count * 1e9 / _total : 0;
+}
+
+double FrameStatistics::meanMillis() const
+{
+    return _count > 0 ? _total / 1e6 / _count : 0;
+}
+
+double FrameStatistics::minMillis() const
+{
+    if (_count == 0)
+        return 0;
+
+    return *std::min_element(_frames.begin(), _frames.begin() + _count) / 1e6;
+}
+
+double FrameStatistics::maxMillis() const
+{
+    if (_count == 0)
+        return 0;
+
+    return *std::max_element(_frames.begin(), _frames.begin() + _count) / 1e6;
+}
+
+double FrameStatistics::percentileMillis(const double percentile) const
+{
+    if (_count == 0)
+        return 0;
+
+    // The window isn't in time order once it wraps, but order doesn't matter here.
+    _sorted.resize(_count);
+    std::copy(_frames.begin(), _frames.begin() + _count, _sorted.begin());
+
+    auto nth = _sorted.begin() + std::min(_count - 1, static_cast<int>(percentile / 100 * _count));
+    std::nth_element(_sorted.begin(), nth, _sorted.end());
+
+    return *nth / 1e6;
+}
+
+QString FrameStatistics::summary() const
+{
+    return QString("%1 FPS  %2 ms (p99 %3 ms)")
+            .arg(fps(), 0, 'f', 2)
+            .arg(meanMillis(), 0, 'f', 2)
+            .arg(percentileMillis(99), 0, 'f', 2);
+}
@@ -0,0 +1,34 @@
+#ifndef FRAMESTATISTICS_H
+#define FRAMESTATISTICS_H
+
+#include <QString>
+#include <QVector>
+
+#include <algorithm>
+
+class FrameStatistics
+{
+public:
+    FrameStatistics(int window = 120);
+
+    void addFrame(const qint64 nsecs);
+    void reset();
+
+    int count() const;
+    double fps() const;
+    double meanMillis() const;
+    double minMillis() const;
+    double maxMillis() const;
+    double percentileMillis(const double percentile) const;
+
+    QString summary() const;
+
+private:
+    QVector<qint64> _frames;
+    mutable QVector<qint64> _sorted;
+    int _next;
+    int _count;
+    qint64 _total;
+};
+
+#endif // FRAMESTATISTICS_H
@@ -0,0 +1,41 @@
+#version 100
+
+// FXAA in its cheapest form: estimate the local edge direction from the luma
+// of the four diagonal neighbours, blend along it, and keep the narrower
+// blend if the wider one overshoots the neighbourhood's luma range.
+
+precision highp float;
+
+varying vec2 texcoord;
+
+uniform sampler2D tex;
+uniform vec2 texelSize;
+
+const vec3 luma = vec3(0.299, 0.587, 0.114);
+const float reduceMul = 1.0 / 8.0;
+const float reduceMin = 1.0 / 128.0;
+const float spanMax = 8.0;
+
+void main() {
+    vec3 rgbM = texture2D(tex, texcoord).rgb;
+    float lumaNW = dot(texture2D(tex, texcoord + vec2(-1.0, -1.0) * texelSize).rgb, luma);
+    float lumaNE = dot(texture2D(tex, texcoord + vec2( 1.0, -1.0) * texelSize).rgb, luma);
+    float lumaSW = dot(texture2D(tex, texcoord + vec2(-1.0,  1.0) * texelSize).rgb, luma);
+    float lumaSE = dot(texture2D(tex, texcoord + vec2( 1.0,  1.0) * texelSize).rgb, luma);
+    float lumaM = dot(rgbM, luma);
+    float lumaMin = min(lumaM, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));
+    float lumaMax = max(lumaM, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));
+
+    vec2 dir = vec2(-((lumaNW + lumaNE) - (lumaSW + lumaSE)), (lumaNW + lumaSW) - (lumaNE + lumaSE));
+    float dirReduce = max((lumaNW + lumaNE + lumaSW + lumaSE) * 0.25 * reduceMul, reduceMin);
+    float rcpDirMin = 1.0 / (min(abs(dir.x), abs(dir.y)) + dirReduce);
+    dir = clamp(dir * rcpDirMin, vec2(-spanMax), vec2(spanMax)) * texelSize;
+
+    vec3 rgbA = 0.5 * (texture2D(tex, texcoord + dir * (1.0 / 3.0 - 0.5)).rgb +
+                       texture2D(tex, texcoord + dir * (2.0 / 3.0 - 0.5)).rgb);
+    vec3 rgbB = rgbA * 0.5 + 0.25 * (texture2D(tex, texcoord - dir * 0.5).rgb +
+                                     texture2D(tex, texcoord + dir * 0.5).rgb);
+    float lumaB = dot(rgbB, luma);
+
+    gl_FragColor = vec4((lumaB < lumaMin || lumaB > lumaMax) ? rgbA : rgbB, 1.0);
+}
@@ -0,0 +1,11 @@
+#version 100
+
+attribute vec2 position;
+
+varying vec2 texcoord;
+
+void main() {
+    texcoord = position * 0.5 + 0.5;
+
+    gl_Position = vec4(position, 0.0, 1.0);
+}
@@ -0,0 +1,170 @@
+#include "gpuprofiler.h"
+
+#include <QtDebug>
+
+QVector<GpuProfiler::Tally> GpuProfiler::_tallies;
+int GpuProfiler::_discarded = 0;
+QMutex GpuProfiler::_mutex;
+
+GpuProfiler::GpuProfiler()
+    : _supported(false)
+    , _active(-1)
+    , _passes{}
+    , _passCount(0)
+#ifndef QT_OPENGL_ES_2
+    , _queries{}
+#endif
+    , _pending{}
+    , _slot(0)
+{
+
+}
+
+void GpuProfiler::initialize()
+{
+#ifndef QT_OPENGL_ES_2
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    _supported = context && !context->isOpenGLES() &&
+        (context->format().version() >= qMakePair(3, 3) || context->hasExtension("GL_ARB_timer_query"));
+
+    for (int slot = 0; _supported && slot < Latency; slot++) {
+        for (int i = 0; i < MaxPasses; i++) {
+            _queries[slot][i] = new QOpenGLTimerQuery;
+            if (!_queries[slot][i]->create()) {
+                _supported = false;
+                break;
+            }
+        }
+    }
+
+    if (!_supported)
+        destroy();
+#endif
+
+    if (!_supported)
+        qDebug() << "GPU profile: timer queries not available, passes are not timed";
+}
+
+void GpuProfiler::destroy()
+{
+#ifndef QT_OPENGL_ES_2
+    for (int slot = 0; slot < Latency; slot++) {
+        for (int i = 0; i < MaxPasses; i++) {
+            delete _queries[slot][i];
+            _queries[slot][i] = nullptr;
+        }
+    }
+#endif
+
+    _supported = false;
+}
+
+void GpuProfiler::begin(const char* pass)
+{
+#ifndef QT_OPENGL_ES_2
+    if (!_supported)
+        return;
+
+    const int i = passIndex(pass);
+    if (i < 0)
+        return;
+
+    _queries[_slot][i]->begin();
+    _pending[_slot][i] = true;
+    _active = i;
+#else
+    Q_UNUSED(pass);
+#endif
+}
+
+void GpuProfiler::end()
+{
+#ifndef QT_OPENGL_ES_2
+    if (_active < 0)
+        return;
+
+    _queries[_slot][_active]->end();
+    _active = -1;
+#endif
+}
+
+void GpuProfiler::frame()
+{
+#ifndef QT_OPENGL_ES_2
+    if (!_supported)
+        return;
+
+    // The next slot holds the oldest frame's queries; collect them before
+    // they are reused.
+    _slot = (_slot + 1) % Latency;
+
+    for (int i = 0; i < _passCount; i++) {
+        if (!_pending[_slot][i])
+            continue;
+        _pending[_slot][i] = false;
+
+        QOpenGLTimerQuery* query = _queries[_slot][i];
+        if (!query->isResultAvailable()) {
+            discard();
+            continue;
+        }
+
+        add(_passes[i], query->waitForResult() / 1e6);
+    }
+#endif
+}
+
+QString GpuProfiler::takeSummary()
+{
+    QMutexLocker locker(&_mutex);
+
+    QStringList passes;
+    for (Tally& tally : _tallies) {
+        if (tally.samples)
+            passes << QString("%1 %2 ms").arg(tally.pass).arg(tally.millis / tally.samples, 0, 'f', 3);
+        tally.millis = 0;
+        tally.samples = 0;
+    }
+
+    if (_discarded)
+        passes << QString("(%1 discarded)").arg(_discarded);
+    _discarded = 0;
+
+    return passes.join(' ');
+}
+
+int GpuProfiler::passIndex(const char* pass)
+{
+    for (int i = 0; i < _passCount; i++) {
+        if (_passes[i] == pass)
+            return i;
+    }
+
+    if (_passCount == MaxPasses)
+        return -1;
+
+    _passes[_passCount] = pass;
+    return _passCount++;
+}
+
+void GpuProfiler::add(const char* pass, const double millis)
+{
+    QMutexLocker locker(&_mutex);
+
+    for (Tally& tally : _tallies) {
+        if (!qstrcmp(tally.pass, pass)) {
+            tally.millis += millis;
+            tally.samples++;
+            return;
+        }
+    }
+
+    _tallies.append({ pass, millis, 1 });
+}
+
+void GpuProfiler::discard()
+{
+    QMutexLocker locker(&_mutex);
+
+    _discarded++;
+}
@@ -0,0 +1,70 @@
+#ifndef GPUPROFILER_H
+#define GPUPROFILER_H
+
+#include <QOpenGLContext>
+#include <QOpenGLTimerQuery>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// GPU time per render pass, from QOpenGLTimerQuery (ARB_timer_query or
+// OpenGL 3.3). Each frame's queries go into one slot of a ring and are read
+// back Latency frames later, when they have long finished, so reading never
+// stalls. Every profiler adds its results to one application-wide tally. On
+// OpenGL ES, or without the extension, every call does nothing.
+class GpuProfiler
+{
+public:
+    GpuProfiler();
+
+    // Call with the context current.
+    void initialize();
+    void destroy();
+
+    // Bracket one pass. Passes are told apart by the name pointer, so use
+    // string literals; they must not nest.
+    void begin(const char* pass);
+    void end();
+
+    // Call once all of a frame's passes are submitted: reads back the oldest
+    // slot.
+    void frame();
+
+    // Mean GPU time per pass since the last call, e.g. "triangle 0.12 ms",
+    // and how many results weren't ready in time and were discarded; empty
+    // when nothing was timed.
+    static QString takeSummary();
+
+private:
+    static const int MaxPasses = 8;
+    static const int Latency = 4;
+
+    struct Tally {
+        const char* pass;
+        double millis;
+        int samples;
+    };
+
+    bool _supported;
+    int _active;
+
+    const char* _passes[MaxPasses];
+    int _passCount;
+
+#ifndef QT_OPENGL_ES_2
+    QOpenGLTimerQuery* _queries[Latency][MaxPasses];
+#endif
+    bool _pending[Latency][MaxPasses];
+    int _slot;
+
+    static QVector<Tally> _tallies;
+    static int _discarded;
+    static QMutex _mutex;
+
+    int passIndex(const char* pass);
+    static void add(const char* pass, const double millis);
+    static void discard();
+};
+
+#endif // GPUPROFILER_H
@@ -15,14 +15,41 @@ DEFINES += QT_DEPRECATED_WARNINGS
 # You can also select to disable deprecated APIs only up to a certain version of Qt.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+# `qmake CONFIG+=trace` records trace spans; without it they compile to nothing.
+trace: DEFINES += HAVE_TRACE
+
 SOURCES += \
+    antialiasing.cpp \
+    framestatistics.cpp \
+    gpuprofiler.cpp \
     main.cpp \
     mainwindow.cpp \
-    trianglewidget.cpp
+    renderthread.cpp \
+    sharedresources.cpp \
+    simclock.cpp \
+    startuptrace.cpp \
+    threadedtrianglewidget.cpp \
+    trace.cpp \
+    trianglerenderer.cpp \
+    trianglewidget.cpp \
+    trianglewindow.cpp
 
 HEADERS += \
+    antialiasing.h \
+    framestatistics.h \
+    gpuprofiler.h \
     mainwindow.h \
-    trianglewidget.h
+    renderthread.h \
+    sharedresources.h \
+    simclock.h \
+    startuptrace.h \
+    threadedtrianglewidget.h \
+    trace.h \
+    trianglerenderer.h \
+    triangleview.h \
+    trianglewidget.h \
+    trianglewindow.h \
+    triplebuffer.h
 
 FORMS += \
     mainwindow.ui
@@ -36,3 +63,28 @@ DISTFILES +=
 
 RESOURCES += \
     shaders.qrc
+
+# The Vulkan viewport is built only when Qt was configured with Vulkan. Its
+# shaders are compiled to SPIR-V at build time and embedded as uint32_t arrays.
+qtConfig(vulkan) {
+    SOURCES += vulkantrianglewindow.cpp
+    HEADERS += vulkantrianglewindow.h
+
+    SPIRV_VERT = vulkan.vert
+    SPIRV_FRAG = vulkan.frag
+
+    spirv_vert.input = SPIRV_VERT
+    spirv_vert.output = ${QMAKE_FILE_BASE}_vert.h
+    spirv_vert.commands = glslangValidator -V --vn ${QMAKE_FILE_BASE}_vert -o ${QMAKE_FILE_OUT} ${QMAKE_FILE_NAME}
+    spirv_vert.variable_out = HEADERS
+    spirv_vert.CONFIG += no_link target_predeps
+
+    spirv_frag.input = SPIRV_FRAG
+    spirv_frag.output = ${QMAKE_FILE_BASE}_frag.h
+    spirv_frag.commands = glslangValidator -V --vn ${QMAKE_FILE_BASE}_frag -o ${QMAKE_FILE_OUT} ${QMAKE_FILE_NAME}
+    spirv_frag.variable_out = HEADERS
+    spirv_frag.CONFIG += no_link target_predeps
+
+    QMAKE_EXTRA_COMPILERS += spirv_vert spirv_frag
+    DISTFILES += vulkan.vert vulkan.frag
+}
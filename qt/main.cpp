@@ -1,12 +1,118 @@
 #include "mainwindow.h"
+#include "startuptrace.h"
+#include "antialiasing.h"
+#include "sharedresources.h"
+#include "trace.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QSurfaceFormat>
+#include <QtDebug>
+#if QT_CONFIG(vulkan)
+#include <QVulkanInstance>
+#include "vulkantrianglewindow.h"
+#endif
 
 int main(int argc, char *argv[])
 {
+    StartupTrace::begin();
+
+    // All viewports' contexts join one share group, so programs and buffers
+    // are compiled and uploaded once however many viewports there are.
+    QCoreApplication::setAttribute(Qt::AA_ShareOpenGLContexts);
+
     QApplication a(argc, argv);
     a.setStyle("fusion");
-    MainWindow w;
-    w.show();
-    return a.exec();
+    StartupTrace::mark("QApplication");
+
+    Trace::init("hello-triangle.trace.json");
+
+    QCommandLineParser parser;
+    QCommandLineOption benchmarkOption("benchmark", "Animate continuously without vsync and report frame statistics.");
+    QCommandLineOption viewportOption("viewport", "Render through a QOpenGLWidget (widget), a QOpenGLWindow (window), a dedicated render thread (threaded) or a QVulkanWindow (vulkan).", "widget|window|threaded|vulkan", "widget");
+    QCommandLineOption sizesOption("sizes", "Benchmark each view size in turn, then quit.", "WxH,...");
+    QCommandLineOption viewportsOption("viewports", "Show the scene in a grid of viewports.", "count", "1");
+    QCommandLineOption aaOption("aa", "Anti-aliasing: none, multisampling through the surface format, or an FXAA filter pass.", "off|msaa2|msaa4|fxaa", "off");
+    parser.addHelpOption();
+    parser.addOption(benchmarkOption);
+    parser.addOption(viewportOption);
+    parser.addOption(sizesOption);
+    parser.addOption(viewportsOption);
+    parser.addOption(aaOption);
+    parser.process(a);
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    const auto skipEmptyParts = Qt::SkipEmptyParts;
+#else
+    const auto skipEmptyParts = QString::SkipEmptyParts;
+#endif
+
+    QList<QSize> sizes;
+    for (const QString& size : parser.value(sizesOption).split(',', skipEmptyParts)) {
+        const QStringList dimensions = size.split('x');
+        if (dimensions.size() == 2)
+            sizes.append(QSize(dimensions[0].toInt(), dimensions[1].toInt()));
+    }
+
+    MainWindow::Viewport viewport = MainWindow::Viewport::Widget;
+    if (parser.value(viewportOption) == "window")
+        viewport = MainWindow::Viewport::Window;
+    else if (parser.value(viewportOption) == "threaded")
+        viewport = MainWindow::Viewport::Threaded;
+    else if (parser.value(viewportOption) == "vulkan")
+        viewport = MainWindow::Viewport::Vulkan;
+
+#if QT_CONFIG(vulkan)
+    // The instance outlives every window that presents through it.
+    QVulkanInstance instance;
+    if (viewport == MainWindow::Viewport::Vulkan) {
+        if (!instance.create()) {
+            qWarning() << "Vulkan: unable to create instance:" << instance.errorCode();
+            return 1;
+        }
+        VulkanTriangleWindow::setInstance(&instance);
+        StartupTrace::mark("QVulkanInstance");
+    }
+#else
+    if (viewport == MainWindow::Viewport::Vulkan) {
+        qWarning() << "Vulkan: this Qt build has no Vulkan support.";
+        return 1;
+    }
+#endif
+
+    AntiAliasing::Mode aa;
+    if (!AntiAliasing::parse(parser.value(aaOption), aa)) {
+        qWarning() << "Unknown anti-aliasing mode" << parser.value(aaOption);
+        return 1;
+    }
+    AntiAliasing::setMode(aa);
+
+    QSurfaceFormat format = QSurfaceFormat::defaultFormat();
+    format.setSamples(AntiAliasing::samples(aa));
+
+    const bool benchmark = parser.isSet(benchmarkOption);
+    if (benchmark || parser.isSet(sizesOption))
+        format.setSwapInterval(0);
+
+    QSurfaceFormat::setDefaultFormat(format);
+
+    int result;
+    {
+        MainWindow w(viewport, qMax(1, parser.value(viewportsOption).toInt()));
+        StartupTrace::mark("MainWindow");
+
+        w.show();
+        StartupTrace::mark("MainWindow::show");
+
+        w.setBenchmark(benchmark || !sizes.isEmpty(), sizes);
+
+        result = a.exec();
+    }
+
+    // Every view has released its resources by now.
+    SharedResources::reportLeaks();
+
+    Trace::write();
+
+    return result;
 }
@@ -4,14 +4,61 @@
 #include <QWindow>
 #include <QScreen>
 #include <QMouseEvent>
+#include <QFile>
+#include <QGridLayout>
+#include <QtMath>
+#include <unistd.h>
 
-MainWindow::MainWindow(QWidget *parent)
+#include <algorithm>
+#include <cmath>
+
+#include "antialiasing.h"
+#include "gpuprofiler.h"
+#include "sharedresources.h"
+#include "trace.h"
+#include "threadedtrianglewidget.h"
+#include "trianglewidget.h"
+#include "trianglewindow.h"
+#if QT_CONFIG(vulkan)
+#include "vulkantrianglewindow.h"
+#endif
+
+namespace {
+    double residentMegabytes()
+    {
+        QFile statm("/proc/self/statm");
+        if (!statm.open(QIODevice::ReadOnly))
+            return 0;
+
+        const QList<QByteArray> fields = statm.readAll().split(' ');
+        if (fields.size() < 2)
+            return 0;
+
+        return fields[1].toLongLong() * sysconf(_SC_PAGESIZE) / (1024.0 * 1024.0);
+    }
+}
+
+// std::min takes it by reference, which needs a definition before C++17.
+constexpr double MainWindow::FullTurnDegrees;
+
+MainWindow::MainWindow(const Viewport viewport, const int viewports, QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
     , _animate(false)
+    , _benchmark(false)
+    , _benchmarkIndex(0)
+    , _benchmarkSeconds(0)
+    , _rotation{0, 0, 0}
+    , _simRotation{0, 0, 0}
+    , _previousSimRotation{0, 0, 0}
+    , _commitPending(false)
+    , _labelsDirty(false)
 {
     ui->setupUi(this);
 
+    QGridLayout* viewLayout = new QGridLayout(ui->viewContainer);
+    viewLayout->setContentsMargins(0, 0, 0, 0);
+
     connect(ui->actionQuit, &QAction::triggered, this, &MainWindow::close);
     connect(ui->xSlider, &QSlider::valueChanged, this, &MainWindow::sliderValueChanged);
     connect(ui->ySlider, &QSlider::valueChanged, this, &MainWindow::sliderValueChanged);
@@ -20,9 +67,27 @@ MainWindow::MainWindow(QWidget *parent)
     connect(ui->animateButton, &QPushButton::clicked, this, &MainWindow::animateButtonClicked);
     connect(ui->quitButton, &QPushButton::clicked, this, &MainWindow::close);
 
-    connect(&_timer, &QTimer::timeout, this, &MainWindow::timerTimedOut);
+    // Viewports are laid out in a square-ish grid, each looking at the scene
+    // from its own camera angle around the Y axis.
+    const int columns = qCeil(qSqrt(viewports));
+    for (int i = 0; i < viewports; i++) {
+        TriangleView* view = createView(viewport);
+
+        QMatrix4x4 camera;
+        camera.rotate(360.0f * i / viewports, {0, 1, 0});
+        view->setCamera(camera);
+
+        viewLayout->addWidget(view->widget(), i / columns, i % columns);
+        _views.append(view);
+    }
+
+    // Labels refresh at most ten times a second, independent of the render rate.
+    connect(&_labelTimer, &QTimer::timeout, this, &MainWindow::updateLabels);
+    _labelTimer.setInterval(100);
+    _labelTimer.setSingleShot(true);
 
-    _timer.setInterval(1000 / 60);
+    connect(&_benchmarkTimer, &QTimer::timeout, this, &MainWindow::reportBenchmark);
+    _benchmarkTimer.setInterval(1000);
 }
 
 MainWindow::~MainWindow()
@@ -30,59 +95,288 @@ MainWindow::~MainWindow()
     delete ui;
 }
 
+TriangleView* MainWindow::createView(const Viewport viewport)
+{
+    // Every view shares its program and buffers through SharedResources. Only
+    // the first view's swaps drive the animation; the rest present with it.
+    const bool drivesAnimation = _views.isEmpty();
+
+    if (viewport == Viewport::Window) {
+        TriangleWindow* window = new TriangleWindow(ui->viewContainer);
+        if (drivesAnimation)
+            connect(window, &QOpenGLWindow::frameSwapped, this, &MainWindow::frameSwapped);
+        return window;
+    }
+
+#if QT_CONFIG(vulkan)
+    if (viewport == Viewport::Vulkan) {
+        VulkanTriangleWindow* window = new VulkanTriangleWindow(ui->viewContainer);
+        if (drivesAnimation)
+            connect(window, &VulkanTriangleWindow::frameSwapped, this, &MainWindow::frameSwapped);
+        return window;
+    }
+#endif
+
+    if (viewport == Viewport::Threaded) {
+        ThreadedTriangleWidget* widget = new ThreadedTriangleWidget(ui->viewContainer);
+        if (drivesAnimation)
+            connect(widget, &QOpenGLWidget::frameSwapped, this, &MainWindow::frameSwapped);
+        return widget;
+    }
+
+    TriangleWidget* widget = new TriangleWidget(ui->viewContainer);
+    if (drivesAnimation)
+        connect(widget, &QOpenGLWidget::frameSwapped, this, &MainWindow::frameSwapped);
+    return widget;
+}
+
+void MainWindow::setBenchmark(const bool benchmark, const QList<QSize>& sizes)
+{
+    _benchmark = benchmark;
+    _benchmarkSizes = sizes;
+    _benchmarkIndex = 0;
+    _benchmarkSeconds = 0;
+
+    if (_benchmark) {
+        if (!_benchmarkSizes.isEmpty())
+            resizeView(_benchmarkSizes.first());
+
+        startAnimation();
+        _benchmarkTimer.start();
+    } else {
+        _benchmarkTimer.stop();
+    }
+}
+
 void MainWindow::sliderValueChanged()
 {
+    TRACE_SCOPE("input");
+
+    _rotation[0] = ui->xSlider->value();
+    _rotation[1] = ui->ySlider->value();
+    _rotation[2] = ui->zSlider->value();
+
+    // Several sliders may change in the same event loop iteration; they are
+    // committed to the widget together once control returns to the loop.
+    scheduleCommit();
+}
+
+void MainWindow::scheduleCommit()
+{
+    if (_commitPending)
+        return;
+
+    _commitPending = true;
+    QMetaObject::invokeMethod(this, "commitScene", Qt::QueuedConnection);
+}
+
+void MainWindow::commitScene()
+{
+    TRACE_SCOPE("commit_scene");
+
+    _commitPending = false;
+
+    for (TriangleView* view : _views)
+        view->setRotation(_rotation[0], _rotation[1], _rotation[2]);
+
+    setLabelsDirty();
+}
+
+void MainWindow::setLabelsDirty()
+{
+    _labelsDirty = true;
+
+    if (!_labelTimer.isActive())
+        updateLabels();
+}
+
+void MainWindow::updateLabels()
+{
+    if (!_labelsDirty)
+        return;
+
+    _labelsDirty = false;
+
     ui->xValueLabel->setText(QString::number(ui->xSlider->value()));
     ui->yValueLabel->setText(QString::number(ui->ySlider->value()));
     ui->zValueLabel->setText(QString::number(ui->zSlider->value()));
 
-    ui->openGLwidget->setXRotation(ui->xSlider->value());
-    ui->openGLwidget->setYRotation(ui->ySlider->value());
-    ui->openGLwidget->setZRotation(ui->zSlider->value());
-    ui->openGLwidget->update();
+    ui->fpsLabel->setText(_animate && _frameStatistics.count() > 0 ? _frameStatistics.summary() : "");
+
+    _labelTimer.start();
 }
 
 void MainWindow::animateButtonClicked()
 {
-    _animate = !_animate;
+    if (_animate)
+        stopAnimation();
+    else
+        startAnimation();
+}
+
+void MainWindow::startAnimation()
+{
+    if (_rotation[0] >= ui->xSlider->maximum() ||
+        _rotation[1] >= ui->ySlider->maximum() ||
+        _rotation[2] >= ui->zSlider->maximum()) {
+        _rotation[0] = _rotation[1] = _rotation[2] = 0;
+    }
+
+    for (int i = 0; i < 3; i++)
+        _simRotation[i] = _previousSimRotation[i] = _rotation[i];
+    _simClock.reset();
+
+    _animate = true;
+    _frameStatistics.reset();
+    _latencyStatistics.reset();
+    _frameTimer.start();
+    _requestTimer.start();
+
+    for (TriangleView* view : _views)
+        view->requestFrame();
+}
+
+void MainWindow::stopAnimation()
+{
+    _animate = false;
 
+    setLabelsDirty();
+}
+
+void MainWindow::frameSwapped()
+{
     if (!_animate)
-        ui->fpsLabel->setText("");
+        return;
 
-    if (_animate) {
-        if (ui->xSlider->value() >= ui->xSlider->maximum() ||
-            ui->ySlider->value() >= ui->ySlider->maximum() ||
-            ui->zSlider->value() >= ui->zSlider->maximum()) {
-            ui->xSlider->setValue(0);
-            ui->ySlider->setValue(0);
-            ui->zSlider->setValue(0);
-        }
+    const qint64 nsecs = _frameTimer.nsecsElapsed();
+    _frameTimer.start();
 
-        _timer.start();
-    } else {
-        _timer.stop();
+    _frameStatistics.addFrame(nsecs);
+    _latencyStatistics.addFrame(_requestTimer.nsecsElapsed());
+
+    advanceAnimation(nsecs / 1e9);
+}
+
+void MainWindow::advanceAnimation(const double seconds)
+{
+    TRACE_SCOPE("advance_animation");
+
+    // The simulation runs in fixed steps however long the frame took, and
+    // the views are shown the state between the last two steps.
+    bool finished = false;
+    const int steps = _simClock.advance(seconds);
+    for (int i = 0; i < steps && !finished; i++)
+        finished = stepAnimation();
+
+    const double alpha = finished ? 1.0 : _simClock.alpha();
+    for (int i = 0; i < 3; i++) {
+        _rotation[i] = _previousSimRotation[i] + (_simRotation[i] - _previousSimRotation[i]) * alpha;
+
+        // The benchmark's simulation keeps counting up so that interpolation
+        // never runs backwards across the wrap.
+        if (_benchmark)
+            _rotation[i] = std::fmod(_rotation[i], FullTurnDegrees);
+    }
+
+    {
+        // One animation step is one transaction: the sliders' own signals are
+        // suppressed and the scene is committed once below.
+        const QSignalBlocker xBlocker(ui->xSlider);
+        const QSignalBlocker yBlocker(ui->ySlider);
+        const QSignalBlocker zBlocker(ui->zSlider);
+
+        ui->xSlider->setValue(static_cast<int>(_rotation[0]));
+        ui->ySlider->setValue(static_cast<int>(_rotation[1]));
+        ui->zSlider->setValue(static_cast<int>(_rotation[2]));
+    }
+
+    if (finished)
+        stopAnimation();
+
+    // Latency runs from the frame request to the swap that presents it.
+    _requestTimer.start();
+
+    commitScene();
+
+    // In benchmark mode frames are requested back-to-back; with the default
+    // swap interval, each swap waits for vertical sync instead.
+    if (_animate) {
+        for (TriangleView* view : _views)
+            view->requestFrame();
     }
 }
 
-void MainWindow::timerTimedOut()
+bool MainWindow::stepAnimation()
 {
-    ui->xSlider->setValue(ui->xSlider->value() + 1);
-    ui->ySlider->setValue(ui->ySlider->value() + 1);
-    ui->zSlider->setValue(ui->zSlider->value() + 1);
+    bool finished = !_benchmark;
+
+    for (int i = 0; i < 3; i++) {
+        _previousSimRotation[i] = _simRotation[i];
+        _simRotation[i] += DegreesPerSecond * _simClock.step();
 
-    if (ui->xSlider->value() >= ui->xSlider->maximum() &&
-        ui->ySlider->value() >= ui->ySlider->maximum() &&
-        ui->zSlider->value() >= ui->zSlider->maximum()) {
-        _timer.stop();
-        _animate = false;
-        ui->fpsLabel->setText("");
+        if (!_benchmark) {
+            _simRotation[i] = std::min(_simRotation[i], FullTurnDegrees);
+            finished = finished && _simRotation[i] >= FullTurnDegrees;
+        }
     }
 
-    float fps = 1000.0 / _time.restart();
+    return finished;
+}
 
-    ui->fpsLabel->setText(QString::number(fps, 'f', 2)+" FPS");
+void MainWindow::resizeView(const QSize& size)
+{
+    ui->viewContainer->setFixedSize(size);
+    adjustSize();
 }
 
+void MainWindow::reportBenchmark()
+{
+    if (_benchmarkSizes.isEmpty()) {
+        qDebug().noquote() << "AA" << AntiAliasing::name(AntiAliasing::mode())
+                           << _frameStatistics.summary()
+                           << QString("min %1 ms max %2 ms")
+                              .arg(_frameStatistics.minMillis(), 0, 'f', 2)
+                              .arg(_frameStatistics.maxMillis(), 0, 'f', 2)
+                           << GpuProfiler::takeSummary();
+        return;
+    }
+
+    // Each size is warmed up, then measured, then the view moves on to the next size.
+    _benchmarkSeconds++;
+
+    if (_benchmarkSeconds == BenchmarkWarmupSeconds) {
+        _frameStatistics.reset();
+        _latencyStatistics.reset();
+        GpuProfiler::takeSummary();
+        return;
+    }
+
+    if (_benchmarkSeconds < BenchmarkWarmupSeconds + BenchmarkMeasureSeconds)
+        return;
+
+    const QSize& size = _benchmarkSizes[_benchmarkIndex];
 
+    if (_benchmarkIndex == 0)
+        qDebug().noquote() << "viewports aa    size        fps      mean ms  p99 ms   latency ms  RSS MB   programs buffers  buf KB   GPU";
 
+    qDebug().noquote() << QString("%1 %2 %3 %4 %5 %6 %7 %8 %9 %10 %11 %12")
+                          .arg(_views.size(), -9)
+                          .arg(AntiAliasing::name(AntiAliasing::mode()), -5)
+                          .arg(QString("%1x%2").arg(size.width()).arg(size.height()), -11)
+                          .arg(_frameStatistics.fps(), -8, 'f', 2)
+                          .arg(_frameStatistics.meanMillis(), -8, 'f', 2)
+                          .arg(_frameStatistics.percentileMillis(99), -8, 'f', 2)
+                          .arg(_latencyStatistics.meanMillis(), -11, 'f', 2)
+                          .arg(residentMegabytes(), -8, 'f', 1)
+                          .arg(SharedResources::programCount(), -8)
+                          .arg(SharedResources::bufferCount(), -8)
+                          .arg(SharedResources::bufferBytes() / 1024.0, -8, 'f', 1)
+                          .arg(GpuProfiler::takeSummary());
 
+    _benchmarkSeconds = 0;
+    if (++_benchmarkIndex < _benchmarkSizes.size()) {
+        resizeView(_benchmarkSizes[_benchmarkIndex]);
+    } else {
+        close();
+    }
+}
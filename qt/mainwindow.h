@@ -2,10 +2,17 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
-#include <QTime>
+#include <QElapsedTimer>
 #include <QTimer>
 #include <QMenu>
 #include <QAction>
+#include <QList>
+#include <QVector>
+#include <QSize>
+
+#include "framestatistics.h"
+#include "simclock.h"
+#include "triangleview.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -16,19 +23,66 @@ class MainWindow : public QMainWindow
     Q_OBJECT
 
 public:
-    MainWindow(QWidget *parent = nullptr);
+    enum class Viewport {
+        Widget,
+        Window,
+        Threaded,
+        Vulkan
+    };
+
+    MainWindow(const Viewport viewport = Viewport::Widget, const int viewports = 1, QWidget *parent = nullptr);
     ~MainWindow();
 
+    void setBenchmark(const bool benchmark, const QList<QSize>& sizes = QList<QSize>());
+
 private:
+    static constexpr double DegreesPerSecond = 60.0;
+    // Where the rotation wraps in the benchmark and stops otherwise.
+    static constexpr double FullTurnDegrees = 360.0;
+    static constexpr int BenchmarkWarmupSeconds = 1;
+    static constexpr int BenchmarkMeasureSeconds = 3;
+
     Ui::MainWindow *ui;
-    QTime _time;
-    QTimer _timer;
+    QVector<TriangleView*> _views;
+    QElapsedTimer _frameTimer;
+    QElapsedTimer _requestTimer;
+    QTimer _labelTimer;
+    QTimer _benchmarkTimer;
+    FrameStatistics _frameStatistics;
+    FrameStatistics _latencyStatistics;
     bool _animate;
+    bool _benchmark;
+
+    QList<QSize> _benchmarkSizes;
+    int _benchmarkIndex;
+    int _benchmarkSeconds;
+
+    // What the views show, and the simulation's rotation after its latest
+    // step and the one before, which it is interpolated from.
+    double _rotation[3];
+    SimClock _simClock;
+    double _simRotation[3];
+    double _previousSimRotation[3];
+
+    bool _commitPending;
+    bool _labelsDirty;
+
+    TriangleView* createView(const Viewport viewport);
+    void scheduleCommit();
+    void setLabelsDirty();
+    void startAnimation();
+    void stopAnimation();
+    void advanceAnimation(const double seconds);
+    bool stepAnimation();
+    void resizeView(const QSize& size);
 
 private slots:
     void sliderValueChanged();
     void animateButtonClicked();
-    void timerTimedOut();
+    void frameSwapped();
+    void commitScene();
+    void updateLabels();
+    void reportBenchmark();
 
 };
 #endif // MAINWINDOW_H
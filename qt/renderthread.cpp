@@ -0,0 +1,171 @@
+#include "renderthread.h"
+
+RenderThread::RenderThread(QOpenGLContext* shareContext, QObject* parent)
+    : QThread(parent)
+    , _shareContext(shareContext)
+    , _running(true)
+{
+    for (int i = 0; i < 3; i++) {
+        _frames.slot(i).fbo = nullptr;
+        _frames.slot(i).readFence = nullptr;
+    }
+
+    // Offscreen surfaces have to be created on the GUI thread.
+    _surface = new QOffscreenSurface;
+    _surface->setFormat(shareContext->format());
+    _surface->create();
+}
+
+RenderThread::~RenderThread()
+{
+    stop();
+    delete _surface;
+}
+
+void RenderThread::publish(const Snapshot& snapshot)
+{
+    _snapshots.back() = snapshot;
+    _snapshots.publish();
+
+    _pending.release();
+}
+
+bool RenderThread::acquireFrame()
+{
+    return _frames.update();
+}
+
+void RenderThread::releaseFrame(QOpenGLExtraFunctions* functions)
+{
+    // The blit may still be queued when the next acquireFrame() hands this slot
+    // back to the render thread. Fence the reads so the next render into the
+    // slot waits for them, and flush so the fence is submitted before another
+    // context waits on it.
+    Frame& frame = _frames.front();
+    if (!frame.fbo)
+        return;
+
+    if (frame.readFence)
+        functions->glDeleteSync(frame.readFence);
+
+    frame.readFence = functions->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    functions->glFlush();
+}
+
+GLuint RenderThread::frameTexture()
+{
+    QOpenGLFramebufferObject* fbo = _frames.front().fbo;
+    return fbo ? fbo->texture() : 0;
+}
+
+QSize RenderThread::frameSize()
+{
+    QOpenGLFramebufferObject* fbo = _frames.front().fbo;
+    return fbo ? fbo->size() : QSize();
+}
+
+void RenderThread::stop()
+{
+    if (!isRunning())
+        return;
+
+    _running = false;
+    _pending.release();
+    wait();
+}
+
+void RenderThread::run()
+{
+    Trace::setThreadName("render");
+
+    QOpenGLContext context;
+    context.setFormat(_shareContext->format());
+    context.setShareContext(_shareContext);
+    if (!context.create()) {
+        qWarning() << "RenderThread: unable to create context.";
+        return;
+    }
+
+    context.makeCurrent(_surface);
+
+    TriangleRenderer renderer;
+    renderer.initialize();
+
+    QSize size;
+
+    while (_running) {
+        _pending.acquire();
+
+        // Collapse any snapshots that queued up while the last frame rendered.
+        _pending.tryAcquire(_pending.available());
+
+        if (!_running)
+            break;
+
+        if (!_snapshots.update())
+            continue;
+
+        render(renderer, context.extraFunctions(), _snapshots.front(), size);
+    }
+
+    for (int i = 0; i < 3; i++) {
+        Frame& frame = _frames.slot(i);
+        if (frame.readFence)
+            context.extraFunctions()->glDeleteSync(frame.readFence);
+
+        delete frame.fbo;
+        frame.fbo = nullptr;
+        frame.readFence = nullptr;
+    }
+
+    renderer.destroy();
+    context.doneCurrent();
+}
+
+void RenderThread::render(TriangleRenderer& renderer, QOpenGLExtraFunctions* functions, const Snapshot& snapshot, QSize& size)
+{
+    TRACE_SCOPE("render_frame");
+
+    if (snapshot.size.isEmpty())
+        return;
+
+    Frame& frame = _frames.back();
+
+    // The GUI context may still be blitting this slot's texture. The wait is
+    // queued on the GPU, so this thread keeps submitting in the meantime.
+    if (frame.readFence) {
+        TRACE_SCOPE("wait_read");
+        functions->glWaitSync(frame.readFence, 0, GL_TIMEOUT_IGNORED);
+        functions->glDeleteSync(frame.readFence);
+        frame.readFence = nullptr;
+    }
+
+    if (!frame.fbo || frame.fbo->size() != snapshot.size) {
+        delete frame.fbo;
+        frame.fbo = new QOpenGLFramebufferObject(snapshot.size, QOpenGLFramebufferObject::CombinedDepthStencil);
+    }
+
+    if (size != snapshot.size) {
+        renderer.resize(snapshot.size.width(), snapshot.size.height());
+        size = snapshot.size;
+    }
+
+    renderer.setRotation(snapshot.rotation[0], snapshot.rotation[1], snapshot.rotation[2]);
+    renderer.setCamera(snapshot.camera);
+
+    frame.fbo->bind();
+    functions->glViewport(0, 0, size.width(), size.height());
+    renderer.paint();
+    frame.fbo->release();
+
+    // The texture is read from the GUI thread's context. Finishing here only
+    // blocks this thread, and guarantees the frame is complete when published.
+    {
+        TRACE_SCOPE("finish");
+        functions->glFinish();
+    }
+
+    _frames.publish();
+
+    emit frameReady();
+}
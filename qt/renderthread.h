@@ -0,0 +1,68 @@
+#ifndef RENDERTHREAD_H
+#define RENDERTHREAD_H
+
+#include <QThread>
+#include <QSemaphore>
+#include <QSize>
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
+#include <QOffscreenSurface>
+#include <QOpenGLFramebufferObject>
+
+#include <atomic>
+
+#include "trianglerenderer.h"
+#include "triplebuffer.h"
+
+// Renders the scene on a worker thread with its own context, shared with the
+// compositing widget's. Scene snapshots come in and finished frames go out
+// through lock-free triple buffers, so neither thread ever waits on the other.
+class RenderThread : public QThread
+{
+    Q_OBJECT
+
+public:
+    struct Snapshot {
+        double rotation[3];
+        QMatrix4x4 camera;
+        QSize size;
+    };
+
+    RenderThread(QOpenGLContext* shareContext, QObject* parent = nullptr);
+    ~RenderThread();
+
+    // GUI thread
+    void publish(const Snapshot& snapshot);
+    bool acquireFrame();
+    void releaseFrame(QOpenGLExtraFunctions* functions);
+    GLuint frameTexture();
+    QSize frameSize();
+    void stop();
+
+signals:
+    void frameReady();
+
+protected:
+    void run() override;
+
+private:
+    struct Frame {
+        QOpenGLFramebufferObject* fbo;
+        // Signalled once the GUI context's last read of the texture completes.
+        GLsync readFence;
+    };
+
+    QOpenGLContext* _shareContext;
+    QOffscreenSurface* _surface;
+
+    TripleBuffer<Snapshot> _snapshots;
+    TripleBuffer<Frame> _frames;
+
+    QSemaphore _pending;
+    std::atomic<bool> _running;
+
+    void render(TriangleRenderer& renderer, QOpenGLExtraFunctions* functions, const Snapshot& snapshot, QSize& size);
+
+};
+
+#endif // RENDERTHREAD_H
@@ -0,0 +1,98 @@
+#include "sharedresources.h"
+
+QHash<QString, SharedResources::Entry<QOpenGLShaderProgram>> SharedResources::_programs;
+QHash<QString, SharedResources::Entry<QOpenGLBuffer>> SharedResources::_buffers;
+QMutex SharedResources::_mutex;
+
+template <typename T>
+T* SharedResources::acquire(QHash<QString, Entry<T>>& entries, const QString& key, const qint64 bytes, const std::function<T*()>& create)
+{
+    QMutexLocker locker(&_mutex);
+
+    auto it = entries.find(key);
+    if (it == entries.end())
+        it = entries.insert(key, { create(), 0, bytes });
+
+    it->references++;
+    return it->resource;
+}
+
+template <typename T>
+bool SharedResources::release(QHash<QString, Entry<T>>& entries, const QString& key, T*& resource)
+{
+    QMutexLocker locker(&_mutex);
+
+    auto it = entries.find(key);
+    if (it == entries.end())
+        return false;
+
+    if (--it->references > 0)
+        return false;
+
+    resource = it->resource;
+    entries.erase(it);
+    return true;
+}
+
+QOpenGLShaderProgram* SharedResources::acquireProgram(const QString& key, const std::function<QOpenGLShaderProgram*()>& create)
+{
+    return acquire(_programs, key, 0, create);
+}
+
+void SharedResources::releaseProgram(const QString& key)
+{
+    QOpenGLShaderProgram* program = nullptr;
+    if (release(_programs, key, program))
+        delete program;
+}
+
+QOpenGLBuffer* SharedResources::acquireBuffer(const QString& key, const qint64 bytes, const std::function<QOpenGLBuffer*()>& create)
+{
+    return acquire(_buffers, key, bytes, create);
+}
+
+void SharedResources::releaseBuffer(const QString& key)
+{
+    QOpenGLBuffer* buffer = nullptr;
+    if (release(_buffers, key, buffer)) {
+        buffer->destroy();
+        delete buffer;
+    }
+}
+
+int SharedResources::programCount()
+{
+    QMutexLocker locker(&_mutex);
+    return _programs.size();
+}
+
+int SharedResources::bufferCount()
+{
+    QMutexLocker locker(&_mutex);
+    return _buffers.size();
+}
+
+qint64 SharedResources::bufferBytes()
+{
+    QMutexLocker locker(&_mutex);
+
+    // QOpenGLBuffer::size() asks GL about the bound buffer, which needs a
+    // current context; this runs from GUI timers, so use the recorded size.
+    qint64 bytes = 0;
+    for (const Entry<QOpenGLBuffer>& entry : _buffers)
+        bytes += entry.bytes;
+
+    return bytes;
+}
+
+int SharedResources::reportLeaks()
+{
+    QMutexLocker locker(&_mutex);
+
+    for (auto it = _programs.constBegin(); it != _programs.constEnd(); ++it)
+        qWarning().noquote() << QString("GL: leaked program \"%1\", %2 references").arg(it.key()).arg(it->references);
+    for (auto it = _buffers.constBegin(); it != _buffers.constEnd(); ++it)
+        qWarning().noquote() << QString("GL: leaked buffer \"%1\", %2 references, %3 bytes").arg(it.key()).arg(it->references).arg(it->bytes);
+
+    return _programs.size() + _buffers.size();
+}
@@ -0,0 +1,54 @@
+#ifndef SHAREDRESOURCES_H
+#define SHAREDRESOURCES_H
+
+#include <QOpenGLShaderProgram>
+#include <QOpenGLBuffer>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+#include <functional>
+
+// Reference-counted GL resources shared by every context in the application's
+// share group (Qt::AA_ShareOpenGLContexts). The first viewport to acquire a
+// resource creates it; the last one to release it destroys it. Acquire and
+// release with a context of the share group current. Whatever is still held
+// once every viewport is gone is reported as a leak.
+class SharedResources
+{
+public:
+    static QOpenGLShaderProgram* acquireProgram(const QString& key, const std::function<QOpenGLShaderProgram*()>& create);
+    static void releaseProgram(const QString& key);
+
+    // bytes is what create allocates; it is kept with the buffer so that
+    // bufferBytes and reportLeaks need no context.
+    static QOpenGLBuffer* acquireBuffer(const QString& key, const qint64 bytes, const std::function<QOpenGLBuffer*()>& create);
+    static void releaseBuffer(const QString& key);
+
+    static int programCount();
+    static int bufferCount();
+    static qint64 bufferBytes();
+
+    // Logs every resource still acquired; returns how many there are.
+    static int reportLeaks();
+
+private:
+    template <typename T>
+    struct Entry {
+        T* resource;
+        int references;
+        qint64 bytes;
+    };
+
+    template <typename T>
+    static T* acquire(QHash<QString, Entry<T>>& entries, const QString& key, const qint64 bytes, const std::function<T*()>& create);
+
+    template <typename T>
+    static bool release(QHash<QString, Entry<T>>& entries, const QString& key, T*& resource);
+
+    static QHash<QString, Entry<QOpenGLShaderProgram>> _programs;
+    static QHash<QString, Entry<QOpenGLBuffer>> _buffers;
+    static QMutex _mutex;
+};
+
+#endif // SHAREDRESOURCES_H
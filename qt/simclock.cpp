@@ -0,0 +1,53 @@
+#include "simclock.h"
+
+SimClock::SimClock(const double step, const int maxSteps)
+    : _step(step)
+    , _maxSteps(maxSteps)
+    , _accumulator(0)
+    , _steps(0)
+    , _droppedSeconds(0)
+{
+
+}
+
+void SimClock::reset()
+{
+    _accumulator = 0;
+}
+
+int SimClock::advance(const double seconds)
+{
+    _accumulator += seconds;
+
+    const double limit = _maxSteps * _step;
+    if (_accumulator > limit) {
+        _droppedSeconds += _accumulator - limit;
+        _accumulator = limit;
+    }
+
+    const int steps = static_cast<int>(_accumulator / _step);
+    _accumulator -= steps * _step;
+    _steps += steps;
+
+    return steps;
+}
+
+double SimClock::alpha() const
+{
+    return _accumulator / _step;
+}
+
+double SimClock::step() const
+{
+    return _step;
+}
+
+quint64 SimClock::steps() const
+{
+    return _steps;
+}
+
+double SimClock::droppedSeconds() const
+{
+    return _droppedSeconds;
+}
@@ -0,0 +1,41 @@
+#ifndef SIMCLOCK_H
+#define SIMCLOCK_H
+
+#include <QtGlobal>
+
+// Runs the simulation in fixed steps, whatever the frame rate: each frame
+// adds the time it took, and the simulation advances a whole number of
+// steps. The time left over is the fraction of a step to interpolate the
+// drawn state by. After a stall only maxSteps are caught up and the rest is
+// dropped, so that one slow frame doesn't make the next slower still.
+class SimClock
+{
+public:
+    static constexpr double DefaultStep = 1.0 / 60.0;
+    static constexpr int DefaultMaxSteps = 5;
+
+    SimClock(const double step = DefaultStep, const int maxSteps = DefaultMaxSteps);
+
+    // Forgets the time accumulated, e.g. when the simulation is resumed.
+    void reset();
+
+    // Adds the seconds elapsed and returns how many steps to run.
+    int advance(const double seconds);
+
+    // How far the next step has progressed, from 0 to 1.
+    double alpha() const;
+
+    double step() const;
+    quint64 steps() const;
+    double droppedSeconds() const;
+
+private:
+    double _step;
+    int _maxSteps;
+    double _accumulator;
+
+    quint64 _steps;
+    double _droppedSeconds;
+};
+
+#endif // SIMCLOCK_H
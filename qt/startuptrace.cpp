@@ -0,0 +1,46 @@
+#include "startuptrace.h"
+
+#include <QtDebug>
+
+QElapsedTimer StartupTrace::_timer;
+QVector<StartupTrace::Mark> StartupTrace::_marks;
+bool StartupTrace::_reported = false;
+QMutex StartupTrace::_mutex;
+
+void StartupTrace::begin()
+{
+    QMutexLocker locker(&_mutex);
+
+    _timer.start();
+    _marks.clear();
+    _reported = false;
+}
+
+void StartupTrace::mark(const QString& phase)
+{
+    QMutexLocker locker(&_mutex);
+
+    _marks.append({ phase, _timer.nsecsElapsed() });
+}
+
+void StartupTrace::report()
+{
+    QMutexLocker locker(&_mutex);
+
+    // With several viewports, only the first one to present reports.
+    if (_reported)
+        return;
+
+    _reported = true;
+
+    qint64 previous = 0;
+
+    qDebug().noquote() << "Startup:";
+    for (const Mark& mark : _marks) {
+        qDebug().noquote() << QString("  %1 %2 ms %3 ms")
+                              .arg(mark.phase, -24)
+                              .arg((mark.nsecs - previous) / 1e6, 8, 'f', 2)
+                              .arg(mark.nsecs / 1e6, 8, 'f', 2);
+        previous = mark.nsecs;
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef STARTUPTRACE_H
+#define STARTUPTRACE_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+class StartupTrace
+{
+public:
+    static void begin();
+    static void mark(const QString& phase);
+    static void report();
+
+private:
+    struct Mark {
+        QString phase;
+        qint64 nsecs;
+    };
+
+    static QElapsedTimer _timer;
+    static QVector<Mark> _marks;
+    static bool _reported;
+    static QMutex _mutex;
+};
+
+#endif // STARTUPTRACE_H
@@ -0,0 +1,102 @@
+#include "threadedtrianglewidget.h"
+
+ThreadedTriangleWidget::ThreadedTriangleWidget(QWidget *parent)
+    : QOpenGLWidget(parent)
+    , _renderThread(nullptr)
+    , _snapshot{{0, 0, 0}, QMatrix4x4(), QSize()}
+{
+    connect(this, &QOpenGLWidget::frameSwapped, this, &ThreadedTriangleWidget::firstFrameSwapped);
+}
+
+ThreadedTriangleWidget::~ThreadedTriangleWidget()
+{
+    makeCurrent();
+
+    delete _renderThread;
+    _blitter.destroy();
+
+    doneCurrent();
+}
+
+void ThreadedTriangleWidget::setRotation(const double xRotation, const double yRotation, const double zRotation)
+{
+    _snapshot.rotation[0] = xRotation;
+    _snapshot.rotation[1] = yRotation;
+    _snapshot.rotation[2] = zRotation;
+
+    if (_renderThread)
+        _renderThread->publish(_snapshot);
+}
+
+void ThreadedTriangleWidget::setCamera(const QMatrix4x4& camera)
+{
+    _snapshot.camera = camera;
+
+    if (_renderThread)
+        _renderThread->publish(_snapshot);
+}
+
+void ThreadedTriangleWidget::requestFrame()
+{
+    update();
+}
+
+QWidget* ThreadedTriangleWidget::widget()
+{
+    return this;
+}
+
+void ThreadedTriangleWidget::resizeGL(int w, int h)
+{
+    _snapshot.size = QSize(w, h);
+
+    if (_renderThread)
+        _renderThread->publish(_snapshot);
+}
+
+void ThreadedTriangleWidget::paintGL()
+{
+    TRACE_SCOPE("blit_frame");
+
+    QOpenGLExtraFunctions* functions = context()->extraFunctions();
+    functions->glClearColor(0, 0, 0, 1);
+    functions->glClear(GL_COLOR_BUFFER_BIT);
+
+    _renderThread->acquireFrame();
+
+    const GLuint texture = _renderThread->frameTexture();
+    if (!texture)
+        return;
+
+    const QRect viewport(QPoint(0, 0), _snapshot.size);
+    const QRect frame(QPoint(0, 0), _renderThread->frameSize());
+
+    _blitter.bind();
+    _blitter.blit(texture, QOpenGLTextureBlitter::targetTransform(frame, viewport), QOpenGLTextureBlitter::OriginBottomLeft);
+    _blitter.release();
+
+    _renderThread->releaseFrame(functions);
+}
+
+void ThreadedTriangleWidget::initializeGL()
+{
+    StartupTrace::mark("GL context");
+
+    _blitter.create();
+
+    _renderThread = new RenderThread(context());
+    connect(_renderThread, &RenderThread::frameReady, this, QOverload<>::of(&QWidget::update), Qt::QueuedConnection);
+    _renderThread->start();
+
+    _renderThread->publish(_snapshot);
+
+    StartupTrace::mark("initializeGL");
+}
+
+void ThreadedTriangleWidget::firstFrameSwapped()
+{
+    disconnect(this, &QOpenGLWidget::frameSwapped, this, &ThreadedTriangleWidget::firstFrameSwapped);
+
+    StartupTrace::mark("first swap");
+    StartupTrace::report();
+}
@@ -0,0 +1,41 @@
+#ifndef THREADEDTRIANGLEWIDGET_H
+#define THREADEDTRIANGLEWIDGET_H
+
+#include <QOpenGLWidget>
+#include <QOpenGLTextureBlitter>
+
+#include "renderthread.h"
+#include "triangleview.h"
+#include "startuptrace.h"
+
+// Composites frames rendered by a RenderThread. The GUI thread only publishes
+// scene snapshots and blits the newest finished frame, so slider handling and
+// layout never sit in series with the scene's GL work.
+class ThreadedTriangleWidget : public QOpenGLWidget, public TriangleView
+{
+    Q_OBJECT
+
+public:
+    ThreadedTriangleWidget(QWidget* parent);
+    ~ThreadedTriangleWidget();
+
+    void setRotation(const double xRotation, const double yRotation, const double zRotation) override;
+    void setCamera(const QMatrix4x4& camera) override;
+    void requestFrame() override;
+    QWidget* widget() override;
+
+protected:
+    void resizeGL(int w, int h) override;
+    void paintGL() override;
+    void initializeGL() override;
+
+private:
+    RenderThread* _renderThread;
+    QOpenGLTextureBlitter _blitter;
+    RenderThread::Snapshot _snapshot;
+
+    void firstFrameSwapped();
+
+};
+
+#endif // THREADEDTRIANGLEWIDGET_H
@@ -0,0 +1,149 @@
+#include "trace.h"
+
+#ifdef HAVE_TRACE
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QTextStream>
+#include <QTimer>
+#include <QtDebug>
+
+#include <csignal>
+
+QString Trace::_path;
+QElapsedTimer Trace::_clock;
+std::atomic<Trace::Buffer*> Trace::_buffers(nullptr);
+std::atomic<int> Trace::_nextTid(1);
+thread_local Trace::Buffer* Trace::_threadBuffer = nullptr;
+
+#ifdef SIGUSR1
+// Writing the file isn't async-signal-safe, so the handler only raises a
+// flag and a timer on the event loop does the rest.
+static volatile std::sig_atomic_t writeRequested = 0;
+
+static void requestWrite(int)
+{
+    writeRequested = 1;
+}
+#endif
+
+void Trace::init(const QString& path)
+{
+    _clock.start();
+
+    const QByteArray environment = qgetenv("TRACE_FILE");
+    _path = environment.isEmpty() ? path : QString::fromLocal8Bit(environment);
+
+#ifdef SIGUSR1
+    QTimer* timer = new QTimer(QCoreApplication::instance());
+    QObject::connect(timer, &QTimer::timeout, []() {
+        if (writeRequested) {
+            writeRequested = 0;
+            Trace::write();
+        }
+    });
+    timer->start(250);
+
+    std::signal(SIGUSR1, requestWrite);
+#endif
+
+    setThreadName("main");
+    qDebug().noquote() << "Trace: writing" << _path << "on exit or SIGUSR1";
+}
+
+void Trace::setThreadName(const char* name)
+{
+    threadBuffer()->threadName = name;
+}
+
+void Trace::write()
+{
+    QFile file(_path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        qWarning().noquote() << "Trace: couldn't write" << _path;
+        return;
+    }
+
+    QTextStream out(&file);
+    const qint64 pid = QCoreApplication::applicationPid();
+    int total = 0;
+    const char* separator = "";
+
+    out << "{\"traceEvents\":[\n";
+
+    for (Buffer* buffer = _buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+        const int count = buffer->count.load(std::memory_order_acquire);
+
+        if (buffer->threadName) {
+            out << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+                << ",\"tid\":" << buffer->tid << ",\"args\":{\"name\":\"" << buffer->threadName << "\"}}";
+            separator = ",\n";
+        }
+
+        for (int i = 0; i < count; i++) {
+            const Event& event = buffer->events[i];
+
+            out << separator << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"ts\":"
+                << QString::number(event.begin / 1e3, 'f', 3) << ",\"dur\":"
+                << QString::number((event.end - event.begin) / 1e3, 'f', 3)
+                << ",\"pid\":" << pid << ",\"tid\":" << buffer->tid << "}";
+            separator = ",\n";
+        }
+
+        total += count;
+        if (buffer->dropped)
+            qWarning() << "Trace: thread" << buffer->tid << "dropped" << buffer->dropped << "events";
+    }
+
+    out << "\n]}\n";
+
+    qDebug().noquote() << "Trace:" << total << "events written to" << _path;
+}
+
+Trace::Buffer* Trace::threadBuffer()
+{
+    if (_threadBuffer)
+        return _threadBuffer;
+
+    // Buffers outlive their threads so write() can still read them.
+    Buffer* buffer = new Buffer;
+    buffer->threadName = nullptr;
+    buffer->tid = _nextTid.fetch_add(1, std::memory_order_relaxed);
+    buffer->count.store(0, std::memory_order_relaxed);
+    buffer->dropped = 0;
+
+    buffer->next = _buffers.load(std::memory_order_relaxed);
+    while (!_buffers.compare_exchange_weak(buffer->next, buffer, std::memory_order_release, std::memory_order_relaxed));
+
+    _threadBuffer = buffer;
+    return buffer;
+}
+
+void Trace::record(const char* name, const qint64 begin, const qint64 end)
+{
+    Buffer* buffer = threadBuffer();
+
+    // Once full, new spans are dropped so what was written stays consistent.
+    const int count = buffer->count.load(std::memory_order_relaxed);
+    if (count == EventsPerThread) {
+        buffer->dropped++;
+        return;
+    }
+
+    buffer->events[count] = { name, begin, end };
+    buffer->count.store(count + 1, std::memory_order_release);
+}
+
+Trace::Scope::Scope(const char* name)
+    : _name(name)
+    , _begin(_clock.nsecsElapsed())
+{
+
+}
+
+Trace::Scope::~Scope()
+{
+    record(_name, _begin, _clock.nsecsElapsed());
+}
+
+#endif // HAVE_TRACE
@@ -0,0 +1,86 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QString>
+
+// Scoped trace spans, written as Chrome trace-event JSON for chrome://tracing
+// or ui.perfetto.dev. Built with `qmake CONFIG+=trace`; otherwise TRACE_SCOPE
+// expands to nothing and the rest of the interface is empty.
+//
+//   TRACE_SCOPE("paint");    // span from here to the end of the block
+
+#ifdef HAVE_TRACE
+
+#include <QElapsedTimer>
+
+#include <atomic>
+
+class Trace
+{
+public:
+    // Writes to path, or $TRACE_FILE, at exit and on SIGUSR1. Call once the
+    // application object exists.
+    static void init(const QString& path);
+    static void setThreadName(const char* name);
+    static void write();
+
+    class Scope
+    {
+    public:
+        Scope(const char* name);
+        ~Scope();
+
+    private:
+        const char* _name;
+        qint64 _begin;
+    };
+
+private:
+    static const int EventsPerThread = 65536;
+
+    struct Event {
+        const char* name;
+        qint64 begin;
+        qint64 end;
+    };
+
+    // Each thread records into its own buffer, so recording takes no lock;
+    // write() only reads the events the owner has published through count.
+    struct Buffer {
+        Buffer* next;
+        const char* threadName;
+        int tid;
+        std::atomic<int> count;
+        int dropped;
+        Event events[EventsPerThread];
+    };
+
+    static QString _path;
+    static QElapsedTimer _clock;
+    static std::atomic<Buffer*> _buffers;
+    static std::atomic<int> _nextTid;
+    static thread_local Buffer* _threadBuffer;
+
+    static Buffer* threadBuffer();
+    static void record(const char* name, const qint64 begin, const qint64 end);
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) Trace::Scope TRACE_CONCAT(_traceScope, __LINE__)(name)
+
+#else
+
+class Trace
+{
+public:
+    static void init(const QString&) {}
+    static void setThreadName(const char*) {}
+    static void write() {}
+};
+
+#define TRACE_SCOPE(name)
+
+#endif // HAVE_TRACE
+
+#endif // TRACE_H
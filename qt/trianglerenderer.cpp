@@ -0,0 +1,307 @@
+#include "trianglerenderer.h"
+
+TriangleRenderer::TriangleRenderer()
+    : _vbo(nullptr)
+    , _program(nullptr)
+    , _target(nullptr)
+    , _fxaaProgram(nullptr)
+    , _fxaaVbo(nullptr)
+    , _xRotation(0)
+    , _yRotation(0)
+    , _zRotation(0)
+    , _submitNsecs(0)
+    , _frames(0)
+{
+
+}
+
+bool TriangleRenderer::setRotation(const double xRotation, const double yRotation, const double zRotation)
+{
+    if (xRotation == _xRotation && yRotation == _yRotation && zRotation == _zRotation)
+        return false;
+
+    _xRotation = xRotation;
+    _yRotation = yRotation;
+    _zRotation = zRotation;
+
+    return true;
+}
+
+void TriangleRenderer::setCamera(const QMatrix4x4& camera)
+{
+    _camera = camera;
+}
+
+void TriangleRenderer::initialize()
+{
+    initializeOpenGLFunctions();
+
+    initVertexArray();
+    initVertexBuffer();
+    initProgram();
+    layout();
+
+    if (AntiAliasing::mode() == AntiAliasing::Mode::FXAA)
+        initFxaa();
+
+    _gpuProfiler.initialize();
+
+    glClearColor(0, 0, 0, 1);
+}
+
+void TriangleRenderer::destroy()
+{
+    if (!_program)
+        return;
+
+    if (_frames > 0)
+        qDebug() << "GL: mean CPU submission" << _submitNsecs / 1e3 / _frames << "us over" << _frames << "frames, AA" << AntiAliasing::name(AntiAliasing::mode());
+
+    _gpuProfiler.destroy();
+
+    delete _target;
+    _target = nullptr;
+
+    if (_fxaaProgram) {
+        _fxaaVao.destroy();
+        SharedResources::releaseBuffer("fxaa");
+        SharedResources::releaseProgram("fxaa");
+        _fxaaVbo = nullptr;
+        _fxaaProgram = nullptr;
+    }
+
+    _vao.destroy();
+
+    SharedResources::releaseBuffer("triangle");
+    SharedResources::releaseProgram("triangle");
+    _vbo = nullptr;
+    _program = nullptr;
+}
+
+void TriangleRenderer::resize(int w, int h)
+{
+    float aspect = static_cast<float>(w) / h;
+    _projection = QMatrix4x4({
+          1.0f, 0.0f, 0.0f, 0.0f,
+          0.0f, aspect, 0.0f, 0.0f,
+          0.0f, 0.0f, 1.0f, 0.0f,
+          0.0f, 0.0f, 0.0f, 1.0f
+      });
+}
+
+void TriangleRenderer::paint()
+{
+    TRACE_SCOPE("paint");
+
+    QElapsedTimer timer;
+    timer.start();
+
+    GLint viewport[4];
+    GLint destination;
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &destination);
+
+    const bool offscreen = bindTarget(QSize(viewport[2], viewport[3]));
+
+    _gpuProfiler.begin("triangle");
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    draw();
+    _gpuProfiler.end();
+
+    if (offscreen) {
+        TRACE_SCOPE("post_process");
+        _gpuProfiler.begin("post_process");
+        resolveTarget(destination);
+        _gpuProfiler.end();
+    }
+
+    _gpuProfiler.frame();
+
+    _submitNsecs += timer.nsecsElapsed();
+    _frames++;
+}
+
+void TriangleRenderer::initVertexArray()
+{
+    _vao.create();
+}
+
+void TriangleRenderer::initVertexBuffer()
+{
+    static const GLfloat vertices[] = {
+        -0.5f, -0.5f, 0, 1.0f, 0.0f, 0.0f,
+         0.0f,  0.5f, 0, 0.0f, 1.0f, 0.0f,
+         0.5f, -0.5f, 0, 0.0f, 0.0f, 1.0f
+    };
+
+    _vbo = SharedResources::acquireBuffer("triangle", sizeof(vertices), []() {
+        QOpenGLBuffer* vbo = new QOpenGLBuffer;
+        vbo->create();
+        vbo->bind();
+        vbo->allocate(sizeof(vertices));
+        vbo->write(0, vertices, sizeof(vertices));
+        vbo->release();
+
+        return vbo;
+    });
+}
+
+void TriangleRenderer::initProgram()
+{
+    _program = SharedResources::acquireProgram("triangle", []() {
+        QElapsedTimer timer;
+        timer.start();
+
+        // Cacheable shaders let Qt store the linked program binary on disk, keyed
+        // on the sources and the GL vendor, renderer and version. Later launches
+        // load the binary and fall back to compiling if the driver rejects it.
+        QOpenGLShaderProgram* program = new QOpenGLShaderProgram;
+        program->addCacheableShaderFromSourceFile(QOpenGLShader::Vertex, ":/program.vert");
+        program->addCacheableShaderFromSourceFile(QOpenGLShader::Fragment, ":/program.frag");
+        if (!program->link())
+            qWarning() << "Program: linking failed." << program->log();
+
+        qDebug() << "Program: built in" << timer.nsecsElapsed() / 1e6 << "ms";
+
+        return program;
+    });
+}
+
+void TriangleRenderer::initFxaa()
+{
+    _fxaaProgram = SharedResources::acquireProgram("fxaa", []() {
+        QOpenGLShaderProgram* program = new QOpenGLShaderProgram;
+        program->addCacheableShaderFromSourceFile(QOpenGLShader::Vertex, ":/fxaa.vert");
+        program->addCacheableShaderFromSourceFile(QOpenGLShader::Fragment, ":/fxaa.frag");
+        if (!program->link())
+            qWarning() << "FXAA: linking failed." << program->log();
+
+        return program;
+    });
+
+    // One triangle that covers the whole viewport
+    static const GLfloat vertices[] = {
+        -1.0f, -1.0f,
+         3.0f, -1.0f,
+        -1.0f,  3.0f
+    };
+
+    _fxaaVbo = SharedResources::acquireBuffer("fxaa", sizeof(vertices), []() {
+        QOpenGLBuffer* vbo = new QOpenGLBuffer;
+        vbo->create();
+        vbo->bind();
+        vbo->allocate(vertices, sizeof(vertices));
+        vbo->release();
+
+        return vbo;
+    });
+
+    _fxaaVao.create();
+    _fxaaVao.bind();
+
+    GLint positionLocation = _fxaaProgram->attributeLocation("position");
+
+    _fxaaVbo->bind();
+    _fxaaProgram->enableAttributeArray(positionLocation);
+    glVertexAttribPointer(positionLocation, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), nullptr);
+
+    _fxaaVao.release();
+    _fxaaVbo->release();
+}
+
+void TriangleRenderer::layout()
+{
+    _vao.bind();
+    _program->bind();
+
+    GLint positionLocation = _program->attributeLocation("position");
+    GLint colorLocation = _program->attributeLocation("color");
+
+    _vbo->bind();
+
+    _program->enableAttributeArray(positionLocation);
+    _program->enableAttributeArray(colorLocation);
+    glVertexAttribPointer(positionLocation, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), reinterpret_cast<void*>(0 * sizeof(GLfloat)));
+    glVertexAttribPointer(colorLocation, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), reinterpret_cast<void*>(3 * sizeof(GLfloat)));
+
+    _vao.release();
+    _vbo->release();
+}
+
+void TriangleRenderer::draw()
+{
+    TRACE_SCOPE("draw_triangle");
+
+    QMatrix4x4 rotation;
+    {
+        TRACE_SCOPE("update_model");
+        rotation.rotate(_xRotation, {1, 0, 0});
+        rotation.rotate(_yRotation, {0, 1, 0});
+        rotation.rotate(_zRotation, {0, 0, 1});
+    }
+
+    // The program is shared between viewports, so every uniform is set per draw.
+    _program->bind();
+    _program->setUniformValue("model", _camera * rotation);
+    _program->setUniformValue("projection", _projection);
+
+    QOpenGLVertexArrayObject::Binder binder(&_vao);
+
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+}
+
+bool TriangleRenderer::bindTarget(const QSize& size)
+{
+    const AntiAliasing::Mode mode = AntiAliasing::mode();
+
+    int samples = 0;
+    if (mode == AntiAliasing::Mode::MSAA2 || mode == AntiAliasing::Mode::MSAA4) {
+        // Surfaces created with the default format already multisample.
+        GLint surfaceSamples;
+        glGetIntegerv(GL_SAMPLES, &surfaceSamples);
+        if (surfaceSamples > 0)
+            return false;
+
+        samples = AntiAliasing::samples(mode);
+    } else if (mode != AntiAliasing::Mode::FXAA) {
+        return false;
+    }
+
+    if (!_target || _target->size() != size) {
+        delete _target;
+
+        QOpenGLFramebufferObjectFormat format;
+        format.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
+        format.setSamples(samples);
+        _target = new QOpenGLFramebufferObject(size, format);
+    }
+
+    _target->bind();
+    return true;
+}
+
+void TriangleRenderer::resolveTarget(const GLuint destination)
+{
+    const QSize size = _target->size();
+
+    if (!_fxaaProgram) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, _target->handle());
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, destination);
+        glBlitFramebuffer(0, 0, size.width(), size.height(), 0, 0, size.width(), size.height(), GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, destination);
+        return;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, destination);
+
+    // The program is shared between viewports, so the texel size is set per draw.
+    _fxaaProgram->bind();
+    _fxaaProgram->setUniformValue("tex", 0);
+    _fxaaProgram->setUniformValue("texelSize", QVector2D(1.0f / size.width(), 1.0f / size.height()));
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, _target->texture());
+
+    QOpenGLVertexArrayObject::Binder binder(&_fxaaVao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+}
@@ -0,0 +1,71 @@
+#ifndef TRIANGLERENDERER_H
+#define TRIANGLERENDERER_H
+
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLShader>
+#include <QOpenGLVertexArrayObject>
+#include <QOpenGLBuffer>
+#include <QOpenGLShaderProgram>
+#include <QMatrix4x4>
+#include <QVector2D>
+#include <QSize>
+#include <QElapsedTimer>
+#include <QtDebug>
+#include <QtMath>
+
+#include "antialiasing.h"
+#include "gpuprofiler.h"
+#include "sharedresources.h"
+#include "trace.h"
+
+class TriangleRenderer : protected QOpenGLExtraFunctions
+{
+public:
+    TriangleRenderer();
+
+    bool setRotation(const double xRotation, const double yRotation, const double zRotation);
+    void setCamera(const QMatrix4x4& camera);
+
+    void initialize();
+    void destroy();
+    void resize(int w, int h);
+    void paint();
+
+private:
+    QOpenGLVertexArrayObject _vao;
+    QOpenGLBuffer* _vbo;
+
+    QOpenGLShaderProgram* _program;
+
+    QMatrix4x4 _camera;
+    QMatrix4x4 _projection;
+
+    // Offscreen copy of the scene, for FXAA, or for MSAA when the surface
+    // drawn to has no samples of its own (the render thread's FBOs).
+    QOpenGLFramebufferObject* _target;
+    QOpenGLShaderProgram* _fxaaProgram;
+    QOpenGLBuffer* _fxaaVbo;
+    QOpenGLVertexArrayObject _fxaaVao;
+
+    GpuProfiler _gpuProfiler;
+
+    void initVertexArray();
+    void initVertexBuffer();
+    void initProgram();
+    void initFxaa();
+    void layout();
+    void draw();
+    bool bindTarget(const QSize& size);
+    void resolveTarget(const GLuint destination);
+
+    double _xRotation;
+    double _yRotation;
+    double _zRotation;
+
+    qint64 _submitNsecs;
+    qint64 _frames;
+
+};
+
+#endif // TRIANGLERENDERER_H
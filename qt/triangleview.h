@@ -0,0 +1,23 @@
+#ifndef TRIANGLEVIEW_H
+#define TRIANGLEVIEW_H
+
+#include <QMatrix4x4>
+
+class QWidget;
+
+// A surface that shows the triangle scene. MainWindow drives any of the
+// implementations through this interface.
+class TriangleView
+{
+public:
+    virtual ~TriangleView() {}
+
+    virtual void setRotation(const double xRotation, const double yRotation, const double zRotation) = 0;
+    virtual void setCamera(const QMatrix4x4& camera) = 0;
+    virtual void requestFrame() = 0;
+
+    // The widget to place in the window's layout.
+    virtual QWidget* widget() = 0;
+};
+
+#endif // TRIANGLEVIEW_H
@@ -3,124 +3,61 @@
 TriangleWidget::TriangleWidget(QWidget *parent)
     : QOpenGLWidget(parent)
 {
+    connect(this, &QOpenGLWidget::frameSwapped, this, &TriangleWidget::firstFrameSwapped);
+}
 
+TriangleWidget::~TriangleWidget()
+{
+    makeCurrent();
+    _renderer.destroy();
+    doneCurrent();
 }
 
-void TriangleWidget::setXRotation(const double xRotation)
+void TriangleWidget::setRotation(const double xRotation, const double yRotation, const double zRotation)
 {
-    _xRotation = xRotation;
+    if (_renderer.setRotation(xRotation, yRotation, zRotation))
+        update();
 }
 
-void TriangleWidget::setYRotation(const double yRotation)
+void TriangleWidget::setCamera(const QMatrix4x4& camera)
 {
-    _yRotation = yRotation;
+    _renderer.setCamera(camera);
+    update();
 }
 
-void TriangleWidget::setZRotation(const double zRotation)
+void TriangleWidget::requestFrame()
 {
-    _zRotation = zRotation;
+    update();
 }
 
-void TriangleWidget::update()
+QWidget* TriangleWidget::widget()
 {
-    QOpenGLWidget::update();
+    return this;
 }
 
 void TriangleWidget::resizeGL(int w, int h)
 {
-    float aspect = static_cast<float>(w) / h;
-    QMatrix4x4 projection({
-          1.0f, 0.0f, 0.0f, 0.0f,
-          0.0f, aspect, 0.0f, 0.0f,
-          0.0f, 0.0f, 1.0f, 0.0f,
-          0.0f, 0.0f, 0.0f, 1.0f
-      });
-
-    _program->setUniformValue("projection", projection);
+    _renderer.resize(w, h);
 }
 
 void TriangleWidget::paintGL()
 {
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    draw();
+    _renderer.paint();
 }
 
 void TriangleWidget::initializeGL()
 {
-    initializeOpenGLFunctions();
-
-    initVertexArray();
-    initVertexBuffer();
-    initProgram();
-    layout();
+    StartupTrace::mark("GL context");
 
-    glClearColor(0, 0, 0, 1);
+    _renderer.initialize();
 
+    StartupTrace::mark("initializeGL");
 }
 
-void TriangleWidget::initVertexArray()
-{
-    _vao.create();
-}
-
-void TriangleWidget::initVertexBuffer()
+void TriangleWidget::firstFrameSwapped()
 {
-    const GLfloat vertices[] = {
-        -0.5f, -0.5f, 0, 1.0f, 0.0f, 0.0f,
-         0.0f,  0.5f, 0, 0.0f, 1.0f, 0.0f,
-         0.5f, -0.5f, 0, 0.0f, 0.0f, 1.0f
-    };
-
-    _vbo.create();
-    _vbo.bind();
-    _vbo.allocate(3 * 6 * sizeof(GLfloat));
-    _vbo.write(0, vertices, sizeof(vertices));
-    _vbo.release();
-}
-
-void TriangleWidget::initProgram()
-{
-    _vertexShader = new QOpenGLShader(QOpenGLShader::Vertex);
-    _vertexShader->compileSourceFile(":/program.vert");
-
-    _fragmentShader = new QOpenGLShader(QOpenGLShader::Fragment);
-    _fragmentShader->compileSourceFile(":/program.frag");
-
-    _program = new QOpenGLShaderProgram;
-    _program->addShader(_vertexShader);
-    _program->addShader(_fragmentShader);
-    _program->link();
-}
-
-void TriangleWidget::layout()
-{
-    _vao.bind();
-    _program->bind();
-
-    GLint positionLocation = _program->attributeLocation("position");
-    GLint colorLocation = _program->attributeLocation("color");
-
-    _vbo.bind();
-
-    _program->enableAttributeArray(positionLocation);
-    _program->enableAttributeArray(colorLocation);
-    glVertexAttribPointer(positionLocation, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), reinterpret_cast<void*>(0 * sizeof(GLfloat)));
-    glVertexAttribPointer(colorLocation, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), reinterpret_cast<void*>(3 * sizeof(GLfloat)));
-
-    _vao.release();
-    _vbo.release();
-}
-
-void TriangleWidget::draw()
-{
-    QMatrix4x4 rotation;
-    rotation.rotate(_xRotation, {1, 0, 0});
-    rotation.rotate(_yRotation, {0, 1, 0});
-    rotation.rotate(_zRotation, {0, 0, 1});
-
-    _program->setUniformValue("model", rotation);
-
-    QOpenGLVertexArrayObject::Binder binder(&_vao);
+    disconnect(this, &QOpenGLWidget::frameSwapped, this, &TriangleWidget::firstFrameSwapped);
 
-    glDrawArrays(GL_TRIANGLES, 0, 3);
+    StartupTrace::mark("first swap");
+    StartupTrace::report();
 }
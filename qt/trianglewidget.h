@@ -2,26 +2,24 @@
 #define TRIANGLEWIDGET_H
 
 #include <QOpenGLWidget>
-#include <QOpenGLFunctions>
-#include <QOpenGLShader>
-#include <QFile>
-#include <QOpenGLVertexArrayObject>
-#include <QOpenGLBuffer>
-#include <QOpenGLShaderProgram>
-#include <QMatrix4x4>
-#include <QtMath>
-
-class TriangleWidget : public QOpenGLWidget, protected QOpenGLFunctions
+
+#include "trianglerenderer.h"
+#include "triangleview.h"
+#include "startuptrace.h"
+
+// Renders into the FBO that QOpenGLWidget composites into the window.
+class TriangleWidget : public QOpenGLWidget, public TriangleView
 {
     Q_OBJECT
 
 public:
     TriangleWidget(QWidget* parent);
+    ~TriangleWidget();
 
-    void setXRotation(const double xRotation);
-    void setYRotation(const double yRotation);
-    void setZRotation(const double zRotation);
-    void update();
+    void setRotation(const double xRotation, const double yRotation, const double zRotation) override;
+    void setCamera(const QMatrix4x4& camera) override;
+    void requestFrame() override;
+    QWidget* widget() override;
 
 protected:
     void resizeGL(int w, int h) override;
@@ -29,22 +27,9 @@ protected:
     void initializeGL() override;
 
 private:
-    QOpenGLVertexArrayObject _vao;
-    QOpenGLBuffer _vbo;
-
-    QOpenGLShader* _vertexShader;
-    QOpenGLShader* _fragmentShader;
-    QOpenGLShaderProgram* _program;
-
-    void initVertexArray();
-    void initVertexBuffer();
-    void initProgram();
-    void layout();
-    void draw();
-
-    double _xRotation;
-    double _yRotation;
-    double _zRotation;
+    TriangleRenderer _renderer;
+
+    void firstFrameSwapped();
 
 };
 
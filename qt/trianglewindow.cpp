@@ -0,0 +1,66 @@
+#include "trianglewindow.h"
+
+TriangleWindow::TriangleWindow(QWidget *parent)
+    : QOpenGLWindow(QOpenGLContext::globalShareContext(), QOpenGLWindow::NoPartialUpdate)
+    , _container(QWidget::createWindowContainer(this, parent))
+{
+    _container->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+
+    connect(this, &QOpenGLWindow::frameSwapped, this, &TriangleWindow::firstFrameSwapped);
+}
+
+TriangleWindow::~TriangleWindow()
+{
+    makeCurrent();
+    _renderer.destroy();
+    doneCurrent();
+}
+
+void TriangleWindow::setRotation(const double xRotation, const double yRotation, const double zRotation)
+{
+    if (_renderer.setRotation(xRotation, yRotation, zRotation))
+        update();
+}
+
+void TriangleWindow::setCamera(const QMatrix4x4& camera)
+{
+    _renderer.setCamera(camera);
+    update();
+}
+
+void TriangleWindow::requestFrame()
+{
+    update();
+}
+
+QWidget* TriangleWindow::widget()
+{
+    return _container;
+}
+
+void TriangleWindow::resizeGL(int w, int h)
+{
+    _renderer.resize(w, h);
+}
+
+void TriangleWindow::paintGL()
+{
+    _renderer.paint();
+}
+
+void TriangleWindow::initializeGL()
+{
+    StartupTrace::mark("GL context");
+
+    _renderer.initialize();
+
+    StartupTrace::mark("initializeGL");
+}
+
+void TriangleWindow::firstFrameSwapped()
+{
+    disconnect(this, &QOpenGLWindow::frameSwapped, this, &TriangleWindow::firstFrameSwapped);
+
+    StartupTrace::mark("first swap");
+    StartupTrace::report();
+}
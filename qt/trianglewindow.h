@@ -0,0 +1,40 @@
+#ifndef TRIANGLEWINDOW_H
+#define TRIANGLEWINDOW_H
+
+#include <QOpenGLWindow>
+#include <QWidget>
+
+#include "trianglerenderer.h"
+#include "triangleview.h"
+#include "startuptrace.h"
+
+// Renders straight to the window surface, skipping the offscreen FBO and the
+// composition pass of QOpenGLWidget. Embedded in the widget hierarchy with
+// QWidget::createWindowContainer.
+class TriangleWindow : public QOpenGLWindow, public TriangleView
+{
+    Q_OBJECT
+
+public:
+    TriangleWindow(QWidget* parent);
+    ~TriangleWindow();
+
+    void setRotation(const double xRotation, const double yRotation, const double zRotation) override;
+    void setCamera(const QMatrix4x4& camera) override;
+    void requestFrame() override;
+    QWidget* widget() override;
+
+protected:
+    void resizeGL(int w, int h) override;
+    void paintGL() override;
+    void initializeGL() override;
+
+private:
+    TriangleRenderer _renderer;
+    QWidget* _container;
+
+    void firstFrameSwapped();
+
+};
+
+#endif // TRIANGLEWINDOW_H
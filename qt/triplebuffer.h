@@ -0,0 +1,68 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+
+// Lock-free single-producer, single-consumer triple buffer. The writer fills
+// back() and publishes it; the reader picks up the newest published slot with
+// update() and reads it through front(). Neither side ever waits, and a slow
+// reader simply skips intermediate values.
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer()
+        : _back(0)
+        , _middle(1)
+        , _front(2)
+    {
+
+    }
+
+    // Writer side.
+
+    T& back()
+    {
+        return _slots[_back];
+    }
+
+    void publish()
+    {
+        _back = _middle.exchange(_back | Fresh, std::memory_order_acq_rel) & IndexMask;
+    }
+
+    // Reader side.
+
+    bool update()
+    {
+        if (!(_middle.load(std::memory_order_relaxed) & Fresh))
+            return false;
+
+        _front = _middle.exchange(_front, std::memory_order_acq_rel) & IndexMask;
+        return true;
+    }
+
+    T& front()
+    {
+        return _slots[_front];
+    }
+
+    // Access to every slot, for setup and teardown while neither side is running.
+
+    T& slot(const int index)
+    {
+        return _slots[index];
+    }
+
+private:
+    static constexpr int IndexMask = 0x3;
+    static constexpr int Fresh = 0x4;
+
+    T _slots[3];
+    int _back;
+    std::atomic<int> _middle;
+    int _front;
+
+};
+
+#endif // TRIPLEBUFFER_H
@@ -0,0 +1,17 @@
+#version 450
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 color;
+
+layout(push_constant) uniform PushConstants {
+    mat4 model;
+    mat4 projection;
+} pushConstants;
+
+layout(location = 0) out vec3 vertColor;
+
+void main() {
+    vertColor = color;
+
+    gl_Position = pushConstants.projection * pushConstants.model * vec4(position, 1.0);
+}
@@ -0,0 +1,359 @@
+#include "vulkantrianglewindow.h"
+
+#include "vulkan_vert.h"
+#include "vulkan_frag.h"
+
+#include <cstring>
+
+QVulkanInstance* VulkanTriangleWindow::_instance = nullptr;
+
+VulkanTriangleRenderer::VulkanTriangleRenderer(VulkanTriangleWindow* window)
+    : _window(window)
+    , _functions(nullptr)
+    , _vertexMemory(VK_NULL_HANDLE)
+    , _vertexBuffer(VK_NULL_HANDLE)
+    , _pipelineCache(VK_NULL_HANDLE)
+    , _pipelineLayout(VK_NULL_HANDLE)
+    , _pipeline(VK_NULL_HANDLE)
+    , _recordNsecs(0)
+    , _frames(0)
+{
+
+}
+
+void VulkanTriangleRenderer::initResources()
+{
+    _functions = _window->vulkanInstance()->deviceFunctions(_window->device());
+
+    initVertexBuffer();
+    initPipeline();
+}
+
+void VulkanTriangleRenderer::initSwapChainResources()
+{
+    const QSize size = _window->swapChainImageSize();
+    const float aspect = static_cast<float>(size.width()) / size.height();
+
+    // Same projection as the GL path, adjusted for Vulkan's flipped Y and
+    // [0, 1] depth range.
+    _projection = _window->clipCorrectionMatrix() * QMatrix4x4({
+          1.0f, 0.0f, 0.0f, 0.0f,
+          0.0f, aspect, 0.0f, 0.0f,
+          0.0f, 0.0f, 1.0f, 0.0f,
+          0.0f, 0.0f, 0.0f, 1.0f
+      });
+}
+
+void VulkanTriangleRenderer::releaseSwapChainResources()
+{
+
+}
+
+void VulkanTriangleRenderer::releaseResources()
+{
+    VkDevice device = _window->device();
+
+    _functions->vkDestroyPipeline(device, _pipeline, nullptr);
+    _functions->vkDestroyPipelineLayout(device, _pipelineLayout, nullptr);
+    _functions->vkDestroyPipelineCache(device, _pipelineCache, nullptr);
+    _functions->vkDestroyBuffer(device, _vertexBuffer, nullptr);
+    _functions->vkFreeMemory(device, _vertexMemory, nullptr);
+
+    _pipeline = VK_NULL_HANDLE;
+    _pipelineLayout = VK_NULL_HANDLE;
+    _pipelineCache = VK_NULL_HANDLE;
+    _vertexBuffer = VK_NULL_HANDLE;
+    _vertexMemory = VK_NULL_HANDLE;
+
+    if (_frames > 0)
+        qDebug() << "Vulkan: mean CPU submission" << _recordNsecs / 1e3 / _frames << "us over" << _frames << "frames";
+}
+
+void VulkanTriangleRenderer::startNextFrame()
+{
+    TRACE_SCOPE("record_frame");
+
+    QElapsedTimer timer;
+    timer.start();
+
+    VkCommandBuffer commandBuffer = _window->currentCommandBuffer();
+    const QSize size = _window->swapChainImageSize();
+
+    VkClearValue clearValues[3];
+    memset(clearValues, 0, sizeof(clearValues));
+    clearValues[0].color = clearValues[2].color = {{ 0.0f, 0.0f, 0.0f, 1.0f }};
+    clearValues[1].depthStencil = { 1.0f, 0 };
+
+    VkRenderPassBeginInfo renderPassBegin;
+    memset(&renderPassBegin, 0, sizeof(renderPassBegin));
+    renderPassBegin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassBegin.renderPass = _window->defaultRenderPass();
+    renderPassBegin.framebuffer = _window->currentFramebuffer();
+    renderPassBegin.renderArea.extent.width = size.width();
+    renderPassBegin.renderArea.extent.height = size.height();
+    renderPassBegin.clearValueCount = _window->sampleCountFlagBits() > VK_SAMPLE_COUNT_1_BIT ? 3 : 2;
+    renderPassBegin.pClearValues = clearValues;
+
+    // QVulkanWindow hands out a fresh primary command buffer per frame. The
+    // stream is kept to the minimum: the matrices change every frame and go
+    // in as push constants, which a pre-recorded buffer couldn't carry.
+    _functions->vkCmdBeginRenderPass(commandBuffer, &renderPassBegin, VK_SUBPASS_CONTENTS_INLINE);
+
+    _functions->vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipeline);
+
+    const QMatrix4x4 model = _window->model();
+    float matrices[32];
+    memcpy(matrices, model.constData(), 16 * sizeof(float));
+    memcpy(matrices + 16, _projection.constData(), 16 * sizeof(float));
+    _functions->vkCmdPushConstants(commandBuffer, _pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(matrices), matrices);
+
+    VkViewport viewport = { 0, 0, static_cast<float>(size.width()), static_cast<float>(size.height()), 0, 1 };
+    _functions->vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+    VkRect2D scissor = { { 0, 0 }, { static_cast<uint32_t>(size.width()), static_cast<uint32_t>(size.height()) } };
+    _functions->vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+    VkDeviceSize offset = 0;
+    _functions->vkCmdBindVertexBuffers(commandBuffer, 0, 1, &_vertexBuffer, &offset);
+    _functions->vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+
+    _functions->vkCmdEndRenderPass(commandBuffer);
+
+    _window->frameReady();
+
+    _recordNsecs += timer.nsecsElapsed();
+    _frames++;
+
+    emit _window->frameSwapped();
+}
+
+void VulkanTriangleRenderer::initVertexBuffer()
+{
+    const float vertices[] = {
+        -0.5f, -0.5f, 0, 1.0f, 0.0f, 0.0f,
+         0.0f,  0.5f, 0, 0.0f, 1.0f, 0.0f,
+         0.5f, -0.5f, 0, 0.0f, 0.0f, 1.0f
+    };
+
+    VkDevice device = _window->device();
+
+    VkBufferCreateInfo bufferInfo;
+    memset(&bufferInfo, 0, sizeof(bufferInfo));
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = sizeof(vertices);
+    bufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+
+    if (_functions->vkCreateBuffer(device, &bufferInfo, nullptr, &_vertexBuffer) != VK_SUCCESS)
+        qFatal("Vulkan: unable to create vertex buffer.");
+
+    VkMemoryRequirements requirements;
+    _functions->vkGetBufferMemoryRequirements(device, _vertexBuffer, &requirements);
+
+    VkMemoryAllocateInfo allocateInfo = {
+        VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        nullptr,
+        requirements.size,
+        _window->hostVisibleMemoryIndex()
+    };
+
+    if (_functions->vkAllocateMemory(device, &allocateInfo, nullptr, &_vertexMemory) != VK_SUCCESS)
+        qFatal("Vulkan: unable to allocate vertex memory.");
+
+    _functions->vkBindBufferMemory(device, _vertexBuffer, _vertexMemory, 0);
+
+    void* data;
+    _functions->vkMapMemory(device, _vertexMemory, 0, requirements.size, 0, &data);
+    memcpy(data, vertices, sizeof(vertices));
+    _functions->vkUnmapMemory(device, _vertexMemory);
+}
+
+void VulkanTriangleRenderer::initPipeline()
+{
+    VkDevice device = _window->device();
+
+    VkPipelineCacheCreateInfo pipelineCacheInfo;
+    memset(&pipelineCacheInfo, 0, sizeof(pipelineCacheInfo));
+    pipelineCacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    _functions->vkCreatePipelineCache(device, &pipelineCacheInfo, nullptr, &_pipelineCache);
+
+    VkPushConstantRange pushConstantRange = { VK_SHADER_STAGE_VERTEX_BIT, 0, 32 * sizeof(float) };
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo;
+    memset(&pipelineLayoutInfo, 0, sizeof(pipelineLayoutInfo));
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (_functions->vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &_pipelineLayout) != VK_SUCCESS)
+        qFatal("Vulkan: unable to create pipeline layout.");
+
+    VkShaderModule vertexShader = createShaderModule(vulkan_vert, sizeof(vulkan_vert));
+    VkShaderModule fragmentShader = createShaderModule(vulkan_frag, sizeof(vulkan_frag));
+
+    VkPipelineShaderStageCreateInfo stages[2] = {
+        { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_VERTEX_BIT, vertexShader, "main", nullptr },
+        { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_FRAGMENT_BIT, fragmentShader, "main", nullptr }
+    };
+
+    VkVertexInputBindingDescription binding = { 0, 6 * sizeof(float), VK_VERTEX_INPUT_RATE_VERTEX };
+    VkVertexInputAttributeDescription attributes[] = {
+        { 0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0 },                    // position
+        { 1, 0, VK_FORMAT_R32G32B32_SFLOAT, 3 * sizeof(float) }     // color
+    };
+
+    VkPipelineVertexInputStateCreateInfo vertexInput;
+    memset(&vertexInput, 0, sizeof(vertexInput));
+    vertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInput.vertexBindingDescriptionCount = 1;
+    vertexInput.pVertexBindingDescriptions = &binding;
+    vertexInput.vertexAttributeDescriptionCount = 2;
+    vertexInput.pVertexAttributeDescriptions = attributes;
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly;
+    memset(&inputAssembly, 0, sizeof(inputAssembly));
+    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    VkPipelineViewportStateCreateInfo viewportState;
+    memset(&viewportState, 0, sizeof(viewportState));
+    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount = 1;
+    viewportState.scissorCount = 1;
+
+    VkPipelineRasterizationStateCreateInfo rasterization;
+    memset(&rasterization, 0, sizeof(rasterization));
+    rasterization.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterization.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterization.cullMode = VK_CULL_MODE_NONE;
+    rasterization.frontFace = VK_FRONT_FACE_CLOCKWISE;
+    rasterization.lineWidth = 1.0f;
+
+    VkPipelineMultisampleStateCreateInfo multisample;
+    memset(&multisample, 0, sizeof(multisample));
+    multisample.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisample.rasterizationSamples = _window->sampleCountFlagBits();
+
+    VkPipelineDepthStencilStateCreateInfo depthStencil;
+    memset(&depthStencil, 0, sizeof(depthStencil));
+    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+
+    VkPipelineColorBlendAttachmentState blendAttachment;
+    memset(&blendAttachment, 0, sizeof(blendAttachment));
+    blendAttachment.colorWriteMask = 0xF;
+
+    VkPipelineColorBlendStateCreateInfo colorBlend;
+    memset(&colorBlend, 0, sizeof(colorBlend));
+    colorBlend.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlend.attachmentCount = 1;
+    colorBlend.pAttachments = &blendAttachment;
+
+    VkDynamicState dynamicStates[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+    VkPipelineDynamicStateCreateInfo dynamic;
+    memset(&dynamic, 0, sizeof(dynamic));
+    dynamic.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamic.dynamicStateCount = 2;
+    dynamic.pDynamicStates = dynamicStates;
+
+    VkGraphicsPipelineCreateInfo pipelineInfo;
+    memset(&pipelineInfo, 0, sizeof(pipelineInfo));
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.stageCount = 2;
+    pipelineInfo.pStages = stages;
+    pipelineInfo.pVertexInputState = &vertexInput;
+    pipelineInfo.pInputAssemblyState = &inputAssembly;
+    pipelineInfo.pViewportState = &viewportState;
+    pipelineInfo.pRasterizationState = &rasterization;
+    pipelineInfo.pMultisampleState = &multisample;
+    pipelineInfo.pDepthStencilState = &depthStencil;
+    pipelineInfo.pColorBlendState = &colorBlend;
+    pipelineInfo.pDynamicState = &dynamic;
+    pipelineInfo.layout = _pipelineLayout;
+    pipelineInfo.renderPass = _window->defaultRenderPass();
+
+    if (_functions->vkCreateGraphicsPipelines(device, _pipelineCache, 1, &pipelineInfo, nullptr, &_pipeline) != VK_SUCCESS)
+        qFatal("Vulkan: unable to create graphics pipeline.");
+
+    _functions->vkDestroyShaderModule(device, vertexShader, nullptr);
+    _functions->vkDestroyShaderModule(device, fragmentShader, nullptr);
+}
+
+VkShaderModule VulkanTriangleRenderer::createShaderModule(const uint32_t* code, const size_t size)
+{
+    VkShaderModuleCreateInfo shaderInfo;
+    memset(&shaderInfo, 0, sizeof(shaderInfo));
+    shaderInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    shaderInfo.codeSize = size;
+    shaderInfo.pCode = code;
+
+    VkShaderModule shader;
+    if (_functions->vkCreateShaderModule(_window->device(), &shaderInfo, nullptr, &shader) != VK_SUCCESS)
+        qFatal("Vulkan: unable to create shader module.");
+
+    return shader;
+}
+
+VulkanTriangleWindow::VulkanTriangleWindow(QWidget* parent)
+    : _xRotation(0)
+    , _yRotation(0)
+    , _zRotation(0)
+{
+    setVulkanInstance(_instance);
+
+    // MSAA maps onto the swapchain's sample count; there is no FXAA pass here.
+    const AntiAliasing::Mode aa = AntiAliasing::mode();
+    if (AntiAliasing::samples(aa) > 0)
+        setSampleCount(AntiAliasing::samples(aa));
+    else if (aa == AntiAliasing::Mode::FXAA)
+        qWarning() << "Vulkan: FXAA is not implemented, rendering without anti-aliasing.";
+
+    _container = QWidget::createWindowContainer(this, parent);
+    _container->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+}
+
+void VulkanTriangleWindow::setInstance(QVulkanInstance* instance)
+{
+    _instance = instance;
+}
+
+void VulkanTriangleWindow::setRotation(const double xRotation, const double yRotation, const double zRotation)
+{
+    if (xRotation == _xRotation && yRotation == _yRotation && zRotation == _zRotation)
+        return;
+
+    _xRotation = xRotation;
+    _yRotation = yRotation;
+    _zRotation = zRotation;
+
+    requestUpdate();
+}
+
+void VulkanTriangleWindow::setCamera(const QMatrix4x4& camera)
+{
+    _camera = camera;
+    requestUpdate();
+}
+
+void VulkanTriangleWindow::requestFrame()
+{
+    requestUpdate();
+}
+
+QWidget* VulkanTriangleWindow::widget()
+{
+    return _container;
+}
+
+QVulkanWindowRenderer* VulkanTriangleWindow::createRenderer()
+{
+    return new VulkanTriangleRenderer(this);
+}
+
+QMatrix4x4 VulkanTriangleWindow::model() const
+{
+    QMatrix4x4 rotation;
+    rotation.rotate(_xRotation, {1, 0, 0});
+    rotation.rotate(_yRotation, {0, 1, 0});
+    rotation.rotate(_zRotation, {0, 0, 1});
+
+    return _camera * rotation;
+}
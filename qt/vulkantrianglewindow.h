@@ -0,0 +1,90 @@
+#ifndef VULKANTRIANGLEWINDOW_H
+#define VULKANTRIANGLEWINDOW_H
+
+#include <QVulkanWindow>
+#include <QVulkanFunctions>
+#include <QMatrix4x4>
+#include <QElapsedTimer>
+#include <QWidget>
+#include <QtDebug>
+
+#include "antialiasing.h"
+#include "trace.h"
+#include "triangleview.h"
+
+class VulkanTriangleWindow;
+
+// Draws the scene with a pipeline whose model and projection matrices are
+// push constants, so no per-frame buffers exist and every frame QVulkanWindow
+// keeps in flight can record independently.
+class VulkanTriangleRenderer : public QVulkanWindowRenderer
+{
+public:
+    VulkanTriangleRenderer(VulkanTriangleWindow* window);
+
+    void initResources() override;
+    void initSwapChainResources() override;
+    void releaseSwapChainResources() override;
+    void releaseResources() override;
+
+    void startNextFrame() override;
+
+private:
+    VulkanTriangleWindow* _window;
+    QVulkanDeviceFunctions* _functions;
+
+    VkDeviceMemory _vertexMemory;
+    VkBuffer _vertexBuffer;
+
+    VkPipelineCache _pipelineCache;
+    VkPipelineLayout _pipelineLayout;
+    VkPipeline _pipeline;
+
+    QMatrix4x4 _projection;
+
+    qint64 _recordNsecs;
+    qint64 _frames;
+
+    void initVertexBuffer();
+    void initPipeline();
+    VkShaderModule createShaderModule(const uint32_t* code, const size_t size);
+
+};
+
+// A QVulkanWindow embedded with QWidget::createWindowContainer, for comparing
+// the CPU cost of submitting the scene through Vulkan against the GL views.
+class VulkanTriangleWindow : public QVulkanWindow, public TriangleView
+{
+    Q_OBJECT
+
+public:
+    VulkanTriangleWindow(QWidget* parent);
+
+    static void setInstance(QVulkanInstance* instance);
+
+    void setRotation(const double xRotation, const double yRotation, const double zRotation) override;
+    void setCamera(const QMatrix4x4& camera) override;
+    void requestFrame() override;
+    QWidget* widget() override;
+
+    QVulkanWindowRenderer* createRenderer() override;
+
+    QMatrix4x4 model() const;
+
+signals:
+    // Emitted once a frame's commands are recorded and queued for presentation.
+    void frameSwapped();
+
+private:
+    static QVulkanInstance* _instance;
+
+    QWidget* _container;
+
+    double _xRotation;
+    double _yRotation;
+    double _zRotation;
+    QMatrix4x4 _camera;
+
+};
+
+#endif // VULKANTRIANGLEWINDOW_H